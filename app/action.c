@@ -91,14 +91,14 @@ void ACTION_Monitor(void)
 	gMonitor = false;
 	
 	if (gScanStateDir != SCAN_OFF) {
-		gScanPauseDelayIn_10ms = scan_pause_delay_in_1_10ms;
+		SCHEDULER_TimerArm(&gScanPauseTimer, scan_pause_delay_in_1_10ms);
 		gScheduleScanListen    = false;
 		gScanPauseMode         = true;
 	}
 
 #ifdef ENABLE_NOAA
 	if (gEeprom.DUAL_WATCH == DUAL_WATCH_OFF && gIsNoaaMode) {
-		gNOAA_Countdown_10ms = NOAA_countdown_10ms;
+		SCHEDULER_TimerArm(&gNOAA_Timer, NOAA_countdown_10ms);
 		gScheduleNOAA        = false;
 	}
 #endif
@@ -142,7 +142,7 @@ void ACTION_Scan(bool bRestart)
 
 					// jump to the next channel
 					CHFRSCANNER_Start(false, gScanStateDir);
-					gScanPauseDelayIn_10ms = 1;
+					SCHEDULER_TimerArm(&gScanPauseTimer, 1);
 					gScheduleScanListen    = false;
 
 					gUpdateStatus = true;
@@ -97,12 +97,8 @@ void AIRCOPY_StorePacket(void)
 			if (Offset < 0x1E00)
 			{
 				pData = &g_FSK_Buffer[2];
-				for (i = 0; i < 8; i++)
-				{
-					EEPROM_WriteBuffer(Offset, pData, true);
-					pData  += 4;
-					Offset += 8;
-				}
+				EEPROM_WriteBlock(Offset, pData, 64, true);
+				Offset += 64;
 				
 				if (Offset == 0x1E00)
 					gAircopyState = AIRCOPY_COMPLETE;
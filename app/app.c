@@ -43,10 +43,12 @@
 	#include "driver/bk1080.h"
 #endif
 #include "driver/bk4819.h"
+#include "driver/eeprom.h"
 #include "driver/gpio.h"
 #include "driver/keyboard.h"
 #include "driver/st7565.h"
 #include "driver/system.h"
+#include "driver/uart.h"
 #include "dtmf.h"
 #include "external/printf/printf.h"
 #include "frequencies.h"
@@ -107,7 +109,7 @@ static void CheckForIncoming(void)
 			#ifdef ENABLE_NOAA
 				if (gIsNoaaMode)
 				{
-					gNOAA_Countdown_10ms = NOAA_countdown_3_10ms;
+					SCHEDULER_TimerArm(&gNOAA_Timer, NOAA_countdown_3_10ms);
 					gScheduleNOAA        = false;
 				}
 			#endif
@@ -139,7 +141,7 @@ static void CheckForIncoming(void)
 			return;
 		}
 
-		gDualWatchCountdown_10ms = dual_watch_count_after_rx_10ms;
+		SCHEDULER_TimerArm(&gDualWatchTimer, dual_watch_count_after_rx_10ms);
 		gScheduleDualWatch       = false;
 
 		// let the user see DW is not active
@@ -161,7 +163,7 @@ static void CheckForIncoming(void)
 			return;
 		}
 
-		gScanPauseDelayIn_10ms = scan_pause_delay_in_3_10ms;
+		SCHEDULER_TimerArm(&gScanPauseTimer, scan_pause_delay_in_3_10ms);
 		gScheduleScanListen    = false;
 	}
 
@@ -196,8 +198,8 @@ static void HandleIncoming(void)
 	bFlag = (gScanStateDir == SCAN_OFF && gCurrentCodeType == CODE_TYPE_OFF);
 
 #ifdef ENABLE_NOAA
-	if (IS_NOAA_CHANNEL(gRxVfo->CHANNEL_SAVE) && gNOAACountdown_10ms > 0) {
-		gNOAACountdown_10ms = 0;
+	if (IS_NOAA_CHANNEL(gRxVfo->CHANNEL_SAVE) && SCHEDULER_TimerPending(&gNOAAIncomingTimer)) {
+		SCHEDULER_TimerCancel(&gNOAAIncomingTimer);
 		bFlag               = true;
 	}
 #endif
@@ -221,7 +223,7 @@ static void HandleIncoming(void)
 
 			if (gDTMF_CallState == DTMF_CALL_STATE_NONE) {
 				if (gRxReceptionMode == RX_MODE_DETECTED) {
-					gDualWatchCountdown_10ms = dual_watch_count_after_1_10ms;
+					SCHEDULER_TimerArm(&gDualWatchTimer, dual_watch_count_after_1_10ms);
 					gScheduleDualWatch       = false;
 
 					gRxReceptionMode = RX_MODE_LISTENING;
@@ -265,8 +267,8 @@ static void HandleReceive(void)
 	}
 
 	if (gCurrentCodeType != CODE_TYPE_OFF
-		&& ((gFoundCTCSS && gFoundCTCSSCountdown_10ms == 0)
-			|| (gFoundCDCSS && gFoundCDCSSCountdown_10ms == 0))
+		&& ((gFoundCTCSS && !SCHEDULER_TimerPending(&gFoundCTCSSTimer))
+			|| (gFoundCDCSS && !SCHEDULER_TimerPending(&gFoundCDCSSTimer)))
 	){
 		gFoundCTCSS = false;
 		gFoundCDCSS = false;
@@ -303,7 +305,7 @@ static void HandleReceive(void)
 					if (!gFoundCTCSS)
 					{
 						gFoundCTCSS               = true;
-						gFoundCTCSSCountdown_10ms = 100;   // 1 sec
+						SCHEDULER_TimerArm(&gFoundCTCSSTimer, 100);   // 1 sec
 					}
 
 					if (g_CxCSS_TAIL_Found)
@@ -323,7 +325,7 @@ static void HandleReceive(void)
 					if (!gFoundCDCSS)
 					{
 						gFoundCDCSS               = true;
-						gFoundCDCSSCountdown_10ms = 100;   // 1 sec
+						SCHEDULER_TimerArm(&gFoundCDCSSTimer, 100);   // 1 sec
 					}
 
 					if (g_CxCSS_TAIL_Found)
@@ -361,7 +363,7 @@ Skip:
 
 			#ifdef ENABLE_NOAA
 				if (IS_NOAA_CHANNEL(gRxVfo->CHANNEL_SAVE))
-					gNOAACountdown_10ms = 300;         // 3 sec
+					SCHEDULER_TimerArm(&gNOAAIncomingTimer, 300);         // 3 sec
 			#endif
 
 			gUpdateDisplay = true;
@@ -374,7 +376,7 @@ Skip:
 						break;
 
 					case SCAN_RESUME_CO:
-						gScanPauseDelayIn_10ms = scan_pause_delay_in_7_10ms;
+						SCHEDULER_TimerArm(&gScanPauseTimer, scan_pause_delay_in_7_10ms);
 						gScheduleScanListen    = false;
 						break;
 
@@ -389,7 +391,7 @@ Skip:
 		case END_OF_RX_MODE_TTE:
 			AUDIO_AudioPathOff();
 
-			gTailNoteEliminationCountdown_10ms = 20;
+			SCHEDULER_TimerArm(&gTailNoteEliminationTimer, 20);
 			gFlagTailNoteEliminationComplete   = false;
 			gEndOfRxDetectedMaybe = true;
 			gEnableSpeaker        = false;
@@ -463,7 +465,7 @@ void APP_StartListening(FUNCTION_Type_t Function)
 		gRxVfo->pTX->Frequency      = NoaaFrequencyTable[gNoaaChannel];
 		gEeprom.ScreenChannel[chan] = gRxVfo->CHANNEL_SAVE;
 
-		gNOAA_Countdown_10ms        = 500;   // 5 sec
+		SCHEDULER_TimerArm(&gNOAA_Timer, 500);   // 5 sec
 		gScheduleNOAA               = false;
 	}
 #endif
@@ -472,7 +474,7 @@ void APP_StartListening(FUNCTION_Type_t Function)
 	    gEeprom.DUAL_WATCH != DUAL_WATCH_OFF)
 	{	// not scanning, dual watch is enabled
 
-		gDualWatchCountdown_10ms = dual_watch_count_after_2_10ms;
+		SCHEDULER_TimerArm(&gDualWatchTimer, dual_watch_count_after_2_10ms);
 		gScheduleDualWatch       = false;
 
 		// when crossband is active only the main VFO should be used for TX
@@ -580,157 +582,151 @@ static void DualwatchAlternate(void)
 	RADIO_SetupRegisters(false);
 
 	#ifdef ENABLE_NOAA
-		gDualWatchCountdown_10ms = gIsNoaaMode ? dual_watch_count_noaa_10ms : dual_watch_count_toggle_10ms;
+		SCHEDULER_TimerArm(&gDualWatchTimer, gIsNoaaMode ? dual_watch_count_noaa_10ms : dual_watch_count_toggle_10ms);
 	#else
-		gDualWatchCountdown_10ms = dual_watch_count_toggle_10ms;
+		SCHEDULER_TimerArm(&gDualWatchTimer, dual_watch_count_toggle_10ms);
 	#endif
 }
 
-static void CheckRadioInterrupts(void)
+static void HandleRadioEvent(const BK4819_Event_t *pEvent)
 {
-	if (SCANNER_IsScanning())
-		return;
-
-	while (BK4819_ReadRegister(BK4819_REG_0C) & 1u)
-	{	// BK chip interrupt request
-
-		uint16_t interrupt_status_bits;
-
-		// reset the interrupt ?
-		BK4819_WriteRegister(BK4819_REG_02, 0);
-
-		// fetch the interrupt status bits
-		interrupt_status_bits = BK4819_ReadRegister(BK4819_REG_02);
-
-		// 0 = no phase shift
-		// 1 = 120deg phase shift
-		// 2 = 180deg phase shift
-		// 3 = 240deg phase shift
-		const uint8_t ctcss_shift = BK4819_GetCTCShift();
-		if (ctcss_shift > 0)
-			g_CTCSS_Lost = true;
-
-		if (interrupt_status_bits & BK4819_REG_02_DTMF_5TONE_FOUND)
-		{	// save the RX'ed DTMF character
-			const char c = DTMF_GetCharacter(BK4819_GetDTMF_5TONE_Code());
-			if (c != 0xff)
+	const uint16_t interrupt_status_bits = pEvent->Status;
+
+	// 0 = no phase shift
+	// 1 = 120deg phase shift
+	// 2 = 180deg phase shift
+	// 3 = 240deg phase shift
+	if (pEvent->CtcShift > 0)
+		g_CTCSS_Lost = true;
+
+	if (interrupt_status_bits & BK4819_REG_02_DTMF_5TONE_FOUND)
+	{	// save the RX'ed DTMF character
+		const char c = DTMF_GetCharacter(pEvent->Dtmf);
+		if (c != 0xff)
+		{
+			if (gCurrentFunction != FUNCTION_TRANSMIT)
 			{
-				if (gCurrentFunction != FUNCTION_TRANSMIT)
+				if (gSetting_live_DTMF_decoder)
 				{
-					if (gSetting_live_DTMF_decoder)
-					{
-						size_t len = strlen(gDTMF_RX_live);
-						if (len >= (sizeof(gDTMF_RX_live) - 1))
-						{	// make room
-							memmove(&gDTMF_RX_live[0], &gDTMF_RX_live[1], sizeof(gDTMF_RX_live) - 1);
-							len--;
-						}
-						gDTMF_RX_live[len++]  = c;
-						gDTMF_RX_live[len]    = 0;
-						gDTMF_RX_live_timeout = DTMF_RX_live_timeout_500ms;  // time till we delete it
-						gUpdateDisplay        = true;
+					size_t len = strlen(gDTMF_RX_live);
+					if (len >= (sizeof(gDTMF_RX_live) - 1))
+					{	// make room
+						memmove(&gDTMF_RX_live[0], &gDTMF_RX_live[1], sizeof(gDTMF_RX_live) - 1);
+						len--;
 					}
+					gDTMF_RX_live[len++]  = c;
+					gDTMF_RX_live[len]    = 0;
+					gDTMF_RX_live_timeout = DTMF_RX_live_timeout_500ms;  // time till we delete it
+					gUpdateDisplay        = true;
+				}
 
 #ifdef ENABLE_DTMF_CALLING
-					if (gRxVfo->DTMF_DECODING_ENABLE || gSetting_KILLED)
-					{
-						if (gDTMF_RX_index >= (sizeof(gDTMF_RX) - 1))
-						{	// make room
-							memmove(&gDTMF_RX[0], &gDTMF_RX[1], sizeof(gDTMF_RX) - 1);
-							gDTMF_RX_index--;
-						}
-						gDTMF_RX[gDTMF_RX_index++] = c;
-						gDTMF_RX[gDTMF_RX_index]   = 0;
-						gDTMF_RX_timeout           = DTMF_RX_timeout_500ms;  // time till we delete it
-						gDTMF_RX_pending           = true;
-
-						DTMF_HandleRequest();
+				if (gRxVfo->DTMF_DECODING_ENABLE || gSetting_KILLED)
+				{
+					if (gDTMF_RX_index >= (sizeof(gDTMF_RX) - 1))
+					{	// make room
+						memmove(&gDTMF_RX[0], &gDTMF_RX[1], sizeof(gDTMF_RX) - 1);
+						gDTMF_RX_index--;
 					}
-#endif
+					gDTMF_RX[gDTMF_RX_index++] = c;
+					gDTMF_RX[gDTMF_RX_index]   = 0;
+					gDTMF_RX_timeout           = DTMF_RX_timeout_500ms;  // time till we delete it
+					gDTMF_RX_pending           = true;
+
+					DTMF_HandleRequest();
 				}
+#endif
 			}
 		}
+	}
 
-		if (interrupt_status_bits & BK4819_REG_02_CxCSS_TAIL)
-			g_CxCSS_TAIL_Found = true;
+	if (interrupt_status_bits & BK4819_REG_02_CxCSS_TAIL)
+		g_CxCSS_TAIL_Found = true;
 
-		if (interrupt_status_bits & BK4819_REG_02_CDCSS_LOST)
-		{
-			g_CDCSS_Lost = true;
-			gCDCSSCodeType = BK4819_GetCDCSSCodeType();
-		}
+	if (interrupt_status_bits & BK4819_REG_02_CDCSS_LOST)
+	{
+		g_CDCSS_Lost = true;
+		gCDCSSCodeType = pEvent->CdcssType;
+	}
 
-		if (interrupt_status_bits & BK4819_REG_02_CDCSS_FOUND)
-			g_CDCSS_Lost = false;
+	if (interrupt_status_bits & BK4819_REG_02_CDCSS_FOUND)
+		g_CDCSS_Lost = false;
 
-		if (interrupt_status_bits & BK4819_REG_02_CTCSS_LOST)
-			g_CTCSS_Lost = true;
+	if (interrupt_status_bits & BK4819_REG_02_CTCSS_LOST)
+		g_CTCSS_Lost = true;
 
-		if (interrupt_status_bits & BK4819_REG_02_CTCSS_FOUND)
-			g_CTCSS_Lost = false;
+	if (interrupt_status_bits & BK4819_REG_02_CTCSS_FOUND)
+		g_CTCSS_Lost = false;
 
-		#ifdef ENABLE_VOX
-			if (interrupt_status_bits & BK4819_REG_02_VOX_LOST)
+	#ifdef ENABLE_VOX
+		if (interrupt_status_bits & BK4819_REG_02_VOX_LOST)
+		{
+			g_VOX_Lost         = true;
+			gVoxPauseCountdown = 10;
+
+			if (gEeprom.VOX_SWITCH)
 			{
-				g_VOX_Lost         = true;
-				gVoxPauseCountdown = 10;
-	
-				if (gEeprom.VOX_SWITCH)
+				if (gCurrentFunction == FUNCTION_POWER_SAVE && !gRxIdleMode)
 				{
-					if (gCurrentFunction == FUNCTION_POWER_SAVE && !gRxIdleMode)
-					{
-						gPowerSave_10ms            = power_save2_10ms;
-						gPowerSaveCountdownExpired = 0;
-					}
-	
-					if (gEeprom.DUAL_WATCH != DUAL_WATCH_OFF && (gScheduleDualWatch || gDualWatchCountdown_10ms < dual_watch_count_after_vox_10ms))
-					{
-						gDualWatchCountdown_10ms = dual_watch_count_after_vox_10ms;
-						gScheduleDualWatch = false;
-	
-						// let the user see DW is not active
-						gDualWatchActive = false;
-						gUpdateStatus    = true;
-					}
+					SCHEDULER_TimerArm(&gPowerSaveTimer, power_save2_10ms);
+					gPowerSaveCountdownExpired = 0;
 				}
-			}
 
-			if (interrupt_status_bits & BK4819_REG_02_VOX_FOUND)
-			{
-				g_VOX_Lost         = false;
-				gVoxPauseCountdown = 0;
+				if (gEeprom.DUAL_WATCH != DUAL_WATCH_OFF && (gScheduleDualWatch || SCHEDULER_TimerRemaining(&gDualWatchTimer) < dual_watch_count_after_vox_10ms))
+				{
+					SCHEDULER_TimerArm(&gDualWatchTimer, dual_watch_count_after_vox_10ms);
+					gScheduleDualWatch = false;
+
+					// let the user see DW is not active
+					gDualWatchActive = false;
+					gUpdateStatus    = true;
+				}
 			}
-		#endif
+		}
 
-		if (interrupt_status_bits & BK4819_REG_02_SQUELCH_LOST)
+		if (interrupt_status_bits & BK4819_REG_02_VOX_FOUND)
 		{
-			g_SquelchLost = true;
-			BK4819_ToggleGpioOut(BK4819_GPIO6_PIN2_GREEN, true);
+			g_VOX_Lost         = false;
+			gVoxPauseCountdown = 0;
 		}
+	#endif
 
-		if (interrupt_status_bits & BK4819_REG_02_SQUELCH_FOUND)
+	if (interrupt_status_bits & BK4819_REG_02_SQUELCH_LOST)
+	{
+		g_SquelchLost = true;
+		BK4819_ToggleGpioOut(BK4819_GPIO6_PIN2_GREEN, true);
+	}
+
+	if (interrupt_status_bits & BK4819_REG_02_SQUELCH_FOUND)
+	{
+		g_SquelchLost = false;
+		BK4819_ToggleGpioOut(BK4819_GPIO6_PIN2_GREEN, false);
+	}
+
+	#ifdef ENABLE_AIRCOPY
+		if (interrupt_status_bits & BK4819_REG_02_FSK_FIFO_ALMOST_FULL &&
+		    gScreenToDisplay == DISPLAY_AIRCOPY &&
+		    gAircopyState == AIRCOPY_TRANSFER &&
+		    gAirCopyIsSendMode == 0)
 		{
-			g_SquelchLost = false;
-			BK4819_ToggleGpioOut(BK4819_GPIO6_PIN2_GREEN, false);
+			unsigned int i;
+			for (i = 0; i < 4; i++)
+				g_FSK_Buffer[gFSKWriteIndex++] = BK4819_ReadRegister(BK4819_REG_5F);
+			AIRCOPY_StorePacket();
 		}
+	#endif
 
-		#ifdef ENABLE_AIRCOPY
-			if (interrupt_status_bits & BK4819_REG_02_FSK_FIFO_ALMOST_FULL &&
-			    gScreenToDisplay == DISPLAY_AIRCOPY &&
-			    gAircopyState == AIRCOPY_TRANSFER &&
-			    gAirCopyIsSendMode == 0)
-			{
-				unsigned int i;
-				for (i = 0; i < 4; i++)
-					g_FSK_Buffer[gFSKWriteIndex++] = BK4819_ReadRegister(BK4819_REG_5F);
-				AIRCOPY_StorePacket();
-			}
-		#endif
+	#ifdef ENABLE_MESSENGER
+		MSG_StorePacket(interrupt_status_bits);
+	#endif
+}
 
-		#ifdef ENABLE_MESSENGER
-			MSG_StorePacket(interrupt_status_bits);
-		#endif
-	}
+static void HandleRadioEvents(void)
+{
+	BK4819_Event_t Event;
+
+	while (BK4819_GetEvent(&Event))
+		HandleRadioEvent(&Event);
 }
 
 void APP_EndTransmission(bool playRoger)
@@ -777,9 +773,9 @@ void APP_EndTransmission(bool playRoger)
 		if (gVOX_NoiseDetected)
 		{
 			if (g_VOX_Lost)
-				gVoxStopCountdown_10ms = vox_stop_count_down_10ms;
+				SCHEDULER_TimerArm(&gVoxStopTimer, vox_stop_count_down_10ms);
 			else
-			if (gVoxStopCountdown_10ms == 0)
+			if (!SCHEDULER_TimerPending(&gVoxStopTimer))
 				gVOX_NoiseDetected = false;
 	
 			if (gCurrentFunction == FUNCTION_TRANSMIT && !gPttIsPressed && !gVOX_NoiseDetected)
@@ -809,7 +805,7 @@ void APP_EndTransmission(bool playRoger)
 			if (gCurrentFunction == FUNCTION_POWER_SAVE)
 				FUNCTION_Select(FUNCTION_FOREGROUND);
 	
-			if (gCurrentFunction != FUNCTION_TRANSMIT && gSerialConfigCountDown_500ms == 0)
+			if (gCurrentFunction != FUNCTION_TRANSMIT && !SCHEDULER_TimerPending(&gSerialConfigTimer))
 			{
 #ifdef ENABLE_DTMF_CALLING
 				gDTMF_ReplyState = DTMF_REPLY_NONE;
@@ -830,7 +826,7 @@ void APP_Update(void)
 	}
 #endif
 
-	if (gCurrentFunction == FUNCTION_TRANSMIT && (gTxTimeoutReached || gSerialConfigCountDown_500ms > 0))
+	if (gCurrentFunction == FUNCTION_TRANSMIT && (gTxTimeoutReached || SCHEDULER_TimerPending(&gSerialConfigTimer)))
 	{	// transmitter timed out or must de-key
 		gTxTimeoutReached = false;
 
@@ -847,6 +843,10 @@ void APP_Update(void)
 	if (gReducedService)
 		return;
 
+	// events queued by the last time slice, ahead of HandleFunction so it
+	// acts on a squelch change straight away
+	HandleRadioEvents();
+
 	if (gCurrentFunction != FUNCTION_TRANSMIT)
 		HandleFunction();
 
@@ -875,7 +875,7 @@ void APP_Update(void)
 			NOAA_IncreaseChannel();
 			RADIO_SetupRegisters(false);
 
-			gNOAA_Countdown_10ms = 7;      // 70ms
+			SCHEDULER_TimerArm(&gNOAA_Timer, 7);      // 70ms
 			gScheduleNOAA        = false;
 		}
 #endif
@@ -937,7 +937,7 @@ void APP_Update(void)
 #endif
 			)
 		{
-			gBatterySaveCountdown_10ms   = battery_save_count_10ms;
+			SCHEDULER_TimerArm(&gBatterySaveTimer, battery_save_count_10ms);
 		}
 		else 
 #ifdef ENABLE_NOAA
@@ -950,7 +950,7 @@ void APP_Update(void)
 #ifdef ENABLE_NOAA
 		else
 		{
-			gBatterySaveCountdown_10ms = battery_save_count_10ms;
+			SCHEDULER_TimerArm(&gBatterySaveTimer, battery_save_count_10ms);
 		}
 #else
 		gSchedulePowerSave = false;
@@ -984,7 +984,7 @@ void APP_Update(void)
 
 			FUNCTION_Init();
 
-			gPowerSave_10ms = power_save1_10ms; // come back here in a bit
+			SCHEDULER_TimerArm(&gPowerSaveTimer, power_save1_10ms); // come back here in a bit
 			gRxIdleMode     = false;            // RX is awake
 		}
 		else
@@ -995,7 +995,7 @@ void APP_Update(void)
 
 			// go back to sleep
 
-			gPowerSave_10ms = gEeprom.BATTERY_SAVE * 10;
+			SCHEDULER_TimerArm(&gPowerSaveTimer, gEeprom.BATTERY_SAVE * 10);
 			gRxIdleMode     = true;
 
 			BK4819_DisableVox();
@@ -1011,7 +1011,7 @@ void APP_Update(void)
 			DualwatchAlternate();
 
 			gUpdateRSSI       = true;
-			gPowerSave_10ms   = power_save1_10ms;
+			SCHEDULER_TimerArm(&gPowerSaveTimer, power_save1_10ms);
 		}
 
 		gPowerSaveCountdownExpired = false;
@@ -1036,9 +1036,9 @@ static void CheckKeys(void)
 // -------------------- PTT ------------------------
 	if (gPttIsPressed)
 	{
-		if (GPIO_CheckBit(&GPIOC->DATA, GPIOC_PIN_PTT) || gSerialConfigCountDown_500ms > 0)
+		if (GPIO_CheckBit(&GPIOC->DATA, GPIOC_PIN_PTT) || SCHEDULER_TimerPending(&gSerialConfigTimer))
 		{	// PTT released or serial comms config in progress
-			if (++gPttDebounceCounter >= 3 || gSerialConfigCountDown_500ms > 0)	    // 30ms
+			if (++gPttDebounceCounter >= 3 || SCHEDULER_TimerPending(&gSerialConfigTimer))	    // 30ms
 			{	// stop transmitting
 				ProcessKey(KEY_PTT, false, false);
 				gPttIsPressed = false;
@@ -1049,11 +1049,11 @@ static void CheckKeys(void)
 		else
 			gPttDebounceCounter = 0;
 	}
-	else if (!GPIO_CheckBit(&GPIOC->DATA, GPIOC_PIN_PTT) && gSerialConfigCountDown_500ms == 0)
+	else if (!GPIO_CheckBit(&GPIOC->DATA, GPIOC_PIN_PTT) && !SCHEDULER_TimerPending(&gSerialConfigTimer))
 	{	// PTT pressed
 		if (++gPttDebounceCounter >= 3)	    // 30ms
 		{	// start transmitting
-			boot_counter_10ms   = 0;
+			SCHEDULER_TimerCancel(&gBootTimer);
 			gPttDebounceCounter = 0;
 			gPttIsPressed       = true;
 			ProcessKey(KEY_PTT, true, false);
@@ -1068,7 +1068,7 @@ static void CheckKeys(void)
 	KEY_Code_t Key = KEYBOARD_Poll();
 
 	if (Key != KEY_INVALID) // any key pressed
-		boot_counter_10ms = 0;   // cancel boot screen/beeps if any key pressed
+		SCHEDULER_TimerCancel(&gBootTimer);   // cancel boot screen/beeps if any key pressed
 
 	if (gKeyReading0 != Key) // new key pressed
 	{	
@@ -1145,11 +1145,13 @@ void APP_TimeSlice10ms(void)
 		__enable_irq();
 	}
 
+	UART_TimeSlice10ms();
+
 	if (gReducedService)
 		return;
 
-	if (gCurrentFunction != FUNCTION_POWER_SAVE || !gRxIdleMode)
-		CheckRadioInterrupts();
+	if ((gCurrentFunction != FUNCTION_POWER_SAVE || !gRxIdleMode) && !SCANNER_IsScanning())
+		BK4819_PollInterrupts();
 
 	if (gCurrentFunction == FUNCTION_TRANSMIT)
 	{	// transmitting
@@ -1297,6 +1299,10 @@ void APP_TimeSlice500ms(void)
 {
 	bool exit_menu = false;
 
+	EEPROM_TimeSlice500ms();
+	UART_TimeSlice500ms();
+	ST7565_TimeSlice500ms();
+
 	#ifdef ENABLE_MESSENGER_NOTIFICATION
 		if (gPlayMSGRing) {
 			gPlayMSGRingCount = 5;
@@ -1395,7 +1401,7 @@ void APP_TimeSlice500ms(void)
 					BACKLIGHT_TurnOff();   // turn backlight off
 	}
 
-	if (gSerialConfigCountDown_500ms > 0)
+	if (SCHEDULER_TimerPending(&gSerialConfigTimer))
 	{
 	}
 
@@ -1405,6 +1411,8 @@ void APP_TimeSlice500ms(void)
 
 		if (gBatteryCalibration[3] < gBatteryCurrentVoltage)
 		{
+			EEPROM_Flush();
+			UART_Flush();
 			#ifdef ENABLE_OVERLAY
 				overlay_FLASH_RebootToBootloader();
 			#else
@@ -1623,7 +1631,7 @@ static void ProcessKey(KEY_Code_t Key, bool bKeyPressed, bool bKeyHeld)
 	if (gCurrentFunction == FUNCTION_POWER_SAVE)
 		FUNCTION_Select(FUNCTION_FOREGROUND);
 
-	gBatterySaveCountdown_10ms = battery_save_count_10ms;
+	SCHEDULER_TimerArm(&gBatterySaveTimer, battery_save_count_10ms);
 
 	if (gEeprom.AUTO_KEYPAD_LOCK)
 		gKeyLockCountdown = 30;     // 15 seconds
@@ -61,7 +61,7 @@ void CHFRSCANNER_Start(const bool storeBackupSettings, const int8_t scan_directi
 		NextFreqChannel();
 	}
 
-	gScanPauseDelayIn_10ms = scan_pause_delay_in_2_10ms;
+	SCHEDULER_TimerArm(&gScanPauseTimer, scan_pause_delay_in_2_10ms);
 	gScheduleScanListen    = false;
 	gRxReceptionMode       = RX_MODE_NONE;
 	gScanPauseMode         = false;
@@ -96,7 +96,7 @@ void CHFRSCANNER_Found(void)
 		case SCAN_RESUME_TO:
 			if (!gScanPauseMode)
 			{
-				gScanPauseDelayIn_10ms = scan_pause_delay_in_1_10ms;
+				SCHEDULER_TimerArm(&gScanPauseTimer, scan_pause_delay_in_1_10ms);
 				gScheduleScanListen    = false;
 				gScanPauseMode         = true;
 			}
@@ -104,7 +104,7 @@ void CHFRSCANNER_Found(void)
 
 		case SCAN_RESUME_CO:
 		case SCAN_RESUME_SE:
-			gScanPauseDelayIn_10ms = 0;
+			SCHEDULER_TimerCancel(&gScanPauseTimer);
 			gScheduleScanListen    = false;
 			break;
 	}
@@ -169,9 +169,9 @@ static void NextFreqChannel(void)
 	RADIO_SetupRegisters(true);
 
 #ifdef ENABLE_FASTER_CHANNEL_SCAN
-	gScanPauseDelayIn_10ms = 9;   // 90ms
+	SCHEDULER_TimerArm(&gScanPauseTimer, 9);   // 90ms
 #else
-	gScanPauseDelayIn_10ms = scan_pause_delay_in_6_10ms;
+	SCHEDULER_TimerArm(&gScanPauseTimer, scan_pause_delay_in_6_10ms);
 #endif
 
 	gUpdateDisplay     = true;
@@ -262,9 +262,9 @@ static void NextMemChannel(void)
 	}
 
 #ifdef ENABLE_FASTER_CHANNEL_SCAN
-	gScanPauseDelayIn_10ms = 9;  // 90ms .. <= ~60ms it misses signals (squelch response and/or PLL lock time) ?
+	SCHEDULER_TimerArm(&gScanPauseTimer, 9);  // 90ms .. <= ~60ms it misses signals (squelch response and/or PLL lock time) ?
 #else
-	gScanPauseDelayIn_10ms = scan_pause_delay_in_3_10ms;
+	SCHEDULER_TimerArm(&gScanPauseTimer, scan_pause_delay_in_3_10ms);
 #endif
 
 	if (enabled)
@@ -99,7 +99,7 @@ void GENERIC_Key_PTT(bool bKeyPressed)
 {
 	gInputBoxIndex = 0;
 
-	if (!bKeyPressed || gSerialConfigCountDown_500ms > 0)
+	if (!bKeyPressed || SCHEDULER_TimerPending(&gSerialConfigTimer))
 	{	// PTT released
 		if (gCurrentFunction == FUNCTION_TRANSMIT)
 		{	// we are transmitting .. stop
@@ -129,7 +129,7 @@ static void processFKeyFunction(const KEY_Code_t Key, const bool beep)
 					{
 						if (gCurrentFunction != FUNCTION_INCOMING ||
 							gRxReceptionMode == RX_MODE_NONE      ||
-							gScanPauseDelayIn_10ms == 0)
+							!SCHEDULER_TimerPending(&gScanPauseTimer))
 						{	// scan is running (not paused)
 							return;
 						}
@@ -750,7 +750,7 @@ static void MAIN_Key_UP_DOWN(bool bKeyPressed, bool bKeyHeld, int8_t Direction)
 
 	// jump to the next channel
 	CHFRSCANNER_Start(false, Direction);
-	gScanPauseDelayIn_10ms = 1;
+	SCHEDULER_TimerArm(&gScanPauseTimer, 1);
 	gScheduleScanListen    = false;
 
 	gPttWasReleased = true;
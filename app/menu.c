@@ -34,6 +34,7 @@
 #include "driver/eeprom.h"
 #include "driver/gpio.h"
 #include "driver/keyboard.h"
+#include "driver/uart.h"
 #include "frequencies.h"
 #include "helper/battery.h"
 #include "misc.h"
@@ -1611,6 +1612,8 @@ static void MENU_Key_MENU(const bool bKeyPressed, const bool bKeyHeld)
 						#endif
 
 						MENU_AcceptSetting();
+						EEPROM_Flush();
+						UART_Flush();
 
 						#if defined(ENABLE_OVERLAY)
 							overlay_FLASH_RebootToBootloader();
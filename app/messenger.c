@@ -584,11 +584,14 @@ void MSG_ConfigureFSK(bool rx)
 	// <6:0>  0 TONE2/FSK tuning gain
 	//        0 ~ 127
 	//
-	BK4819_WriteRegister(BK4819_REG_70,
+	BK4819_RegWrite_t fsk[8];
+	unsigned          n = 0;
+
+	fsk[n++] = (BK4819_RegWrite_t){BK4819_REG_70,
 		( 0u << 15) |    // 0
 		( 0u <<  8) |    // 0
 		( 1u <<  7) |    // 1
-		(96u <<  0));    // 96
+		(96u <<  0)};    // 96
 
 	// Tone2 = FSK baudrate                       // kamilsss655 2024
 	switch(gEeprom.MESSENGER_CONFIG.data.modulation)
@@ -604,13 +607,13 @@ void MSG_ConfigureFSK(bool rx)
 			break;
 	}
 
-	BK4819_WriteRegister(BK4819_REG_72, TONE2_FREQ);
-	
+	fsk[n++] = (BK4819_RegWrite_t){BK4819_REG_72, TONE2_FREQ};
+
 	switch(gEeprom.MESSENGER_CONFIG.data.modulation)
 	{
 		case MOD_FSK_700:
 		case MOD_FSK_450:
-			BK4819_WriteRegister(BK4819_REG_58,
+			fsk[n++] = (BK4819_RegWrite_t){BK4819_REG_58,
 				(0u << 13) |		// 1 FSK TX mode selection
 									//   0 = FSK 1.2K and FSK 2.4K TX .. no tones, direct FM
 									//   1 = FFSK 1200 / 1800 TX
@@ -653,12 +656,12 @@ void MSG_ConfigureFSK(bool rx)
 									//   6 = ???
 									//   7 = ???
 									//
-				(1u << 0));			// 1 FSK enable
+				(1u << 0)};			// 1 FSK enable
 									//   0 = disable
 									//   1 = enable
 		break;
 		case MOD_AFSK_1200:
-			BK4819_WriteRegister(BK4819_REG_58,
+			fsk[n++] = (BK4819_RegWrite_t){BK4819_REG_58,
 				(1u << 13) |		// 1 FSK TX mode selection
 									//   0 = FSK 1.2K and FSK 2.4K TX .. no tones, direct FM
 									//   1 = FFSK 1200 / 1800 TX
@@ -701,7 +704,7 @@ void MSG_ConfigureFSK(bool rx)
 									//   6 = ???
 									//   7 = ???
 									//
-				(1u << 0));			// 1 FSK enable
+				(1u << 0)};			// 1 FSK enable
 									//   0 = disable
 									//   1 = enable
 		break;
@@ -711,20 +714,20 @@ void MSG_ConfigureFSK(bool rx)
 	//
 	// <15:8> sync byte 0
 	// < 7:0> sync byte 1
-	BK4819_WriteRegister(BK4819_REG_5A, 0x3072);
+	fsk[n++] = (BK4819_RegWrite_t){BK4819_REG_5A, 0x3072};
 
 	// REG_5B .. bytes 2 & 3 sync pattern
 	//
 	// <15:8> sync byte 2
 	// < 7:0> sync byte 3
-	BK4819_WriteRegister(BK4819_REG_5B, 0x576C);
+	fsk[n++] = (BK4819_RegWrite_t){BK4819_REG_5B, 0x576C};
 
 	// disable CRC
-	BK4819_WriteRegister(BK4819_REG_5C, 0x5625);
+	fsk[n++] = (BK4819_RegWrite_t){BK4819_REG_5C, 0x5625};
 
 	// set the almost full threshold
 	if(rx)
-		BK4819_WriteRegister(BK4819_REG_5E, (64u << 3) | (1u << 0));  // 0 ~ 127, 0 ~ 7
+		fsk[n++] = (BK4819_RegWrite_t){BK4819_REG_5E, (64u << 3) | (1u << 0)};  // 0 ~ 127, 0 ~ 7
 
 	// packet size .. sync + packet - size of a single packet
 
@@ -733,7 +736,9 @@ void MSG_ConfigureFSK(bool rx)
 	if(rx)
 		size = (((size + 1) / 2) * 2) + 2;             // round up to even, else FSK RX doesn't work
 
-	BK4819_WriteRegister(BK4819_REG_5D, (size << 8));
+	fsk[n++] = (BK4819_RegWrite_t){BK4819_REG_5D, (size << 8)};
+
+	BK4819_WriteRegisters(fsk, n);
 	// BK4819_WriteRegister(BK4819_REG_5D, ((sizeof(dataPacket.serializedArray)) << 8));
 
 	// clear FIFO's
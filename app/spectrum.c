@@ -26,6 +26,10 @@
   #include "common.h"
 #endif
 #include "action.h"
+#include "scheduler.h"
+#ifdef ENABLE_SPECTRUM_UART
+  #include "app/uart.h"
+#endif
 
 struct FrequencyBandInfo {
     uint32_t lower;
@@ -95,6 +99,11 @@ static bool IsBlacklisted(uint16_t idx);
 static uint8_t CurrentScanIndex();
 #endif
 
+#ifdef ENABLE_SPECTRUM_WIDE_SCAN
+static void SetupWideScan();
+static void SaveWideSample(uint16_t rssi);
+#endif
+
 const char *bwOptions[] = {"  25k", "12.5k", "6.25k"};
 const char *scanListOptions[] = {"SL I", "SL II", "ALL"};
 const uint8_t modulationTypeTuneSteps[] = {100, 50, 10};
@@ -135,6 +144,83 @@ RegisterSpec registerSpecs[] = {
 
 uint16_t statuslineUpdateTimer = 0;
 
+// Sweep engine: the next step is tuned as soon as the RSSI of the current one
+// has been read, so storing it and drawing run while the PLL settles, and the
+// first REG_63 poll waits for the settling time last measured on the band.
+#define SETTLE_POLL_US 20
+#define SETTLE_MAX_US  2000
+
+static uint16_t settleUs[BAND7_470MHz + 1];
+static uint32_t tuneStart;
+static uint8_t  tuneBand;
+static bool     tuneSettling;
+static int8_t   lnaPath = -1;
+static bool     prefetched;
+
+static uint32_t sweepWindowStart;
+static uint16_t sweepsInWindow;
+static uint16_t sweepRate;      // sweeps per 10s
+
+// Traces: every bin also keeps a max-hold that falls back to the signal, a
+// moving average and a min-hold that rises to it, in 1/16 RSSI units so the
+// slow ones don't get stuck on rounding. One sample costs the same as any
+// other, whatever the history behind it.
+#define TRACE_FRAC        4
+#define TRACE_HOLD_SHIFT  5   // max/min move 1/32 of the way per sample
+#define TRACE_AVG_SHIFT   3   // average takes 1/8 of every sample
+
+#define TRACE_NONE        0xFFFF  // not started, samples stop at 0x0FFF << TRACE_FRAC
+
+static uint16_t traceMax[128];
+static uint16_t traceAvg[128];
+static uint16_t traceMin[128];
+
+static const char *const traceModeNames[] = {"", "MAX", "AVG", "MIN"};
+static bool     traceKeyDown;    // 8 went down, its tap waits for the release
+static bool     traceKeyHeld;    // and it was held, which stepped the trace mode
+
+#ifdef ENABLE_SPECTRUM_WIDE_SCAN
+// Wide scan: with more than 128 steps every step keeps its own byte (RSSI/2,
+// 0 = not measured) instead of being folded into the 128 bins. Past
+// WIDE_SCAN_SAMPLES steps the buffer goes up a tier and a byte holds the
+// strongest of 2^tier neighbouring steps. The bins on screen are decimated to
+// min/max/mean from the zoomed window of samples, so zooming needs no sweep.
+#define WIDE_SCAN_SAMPLES  2048
+#define WIDE_SCAN_ZOOM_MIN 32
+
+static uint8_t  wideSamples[WIDE_SCAN_SAMPLES];
+static uint8_t  wideMin[128];
+static uint8_t  wideMean[128];
+static uint8_t  wideTier;
+static uint16_t wideCount;      // samples in use, 0 when not a wide scan
+static uint16_t zoomStart;
+static uint16_t zoomCount;
+#endif
+
+#ifdef ENABLE_SPECTRUM_WATERFALL
+// Waterfall: every finished sweep is kept as a row of 4 bit levels, two
+// columns per byte. The rows on screen live in a page image that scrolls down
+// one pixel per sweep, so only the new row gets dithered; the image is rebuilt
+// from the history only when it is scrolled.
+#define WATERFALL_ROWS    48
+#define WATERFALL_PAGE    1
+#define WATERFALL_PAGES   4
+#define WATERFALL_VISIBLE (WATERFALL_PAGES * 8)
+
+static uint8_t waterfall[WATERFALL_ROWS][64];
+static uint8_t waterfallImage[WATERFALL_PAGES][128];
+static uint8_t waterfallHead;     // slot of the newest row
+static uint8_t waterfallCount;
+static uint8_t waterfallOffset;   // rows scrolled back
+static bool    waterfallView;
+static bool    waterfallFrozen;
+
+// ordered dither, indexed by slot so a row keeps its pattern while scrolling
+static const uint8_t waterfallDither[4][4] = {
+    {0, 8, 2, 10}, {12, 4, 14, 6}, {3, 11, 1, 9}, {15, 7, 13, 5},
+};
+#endif
+
 static void RelaunchScan();
 static void CheckIfTailFound();
 static void ResetInterrupts();
@@ -227,13 +313,38 @@ static void ToggleAFDAC(bool on) {
   BK4819_WriteRegister(BK4819_REG_30, Reg);
 }
 
+// Microseconds since the last SetF, fine as long as that was less than a
+// tick period ago
+static uint32_t TuneElapsedUs() {
+  uint32_t now = SYSTICK_GetElapsed();
+  if (now < tuneStart)
+    now += SYSTICK_TICK_CYCLES;
+  return (now - tuneStart) / (SYSTICK_TICK_CYCLES / 10000);
+}
+
 static void SetF(uint32_t f) {
-  fMeasure = f;
-  BK4819_SetFrequency(fMeasure + gEeprom.RX_OFFSET);
-  BK4819_PickRXFilterPathBasedOnFrequency(fMeasure);
+  const uint32_t tuned = f + gEeprom.RX_OFFSET;
+  const bool uhf = f >= 28000000;
   uint16_t reg = BK4819_ReadRegister(BK4819_REG_30);
-  BK4819_WriteRegister(BK4819_REG_30, 0);
-  BK4819_WriteRegister(BK4819_REG_30, reg);
+  BK4819_RegWrite_t tune[5];
+  unsigned n = 0;
+
+  fMeasure = f;
+  // the LNA only has to be switched when crossing 280MHz
+  if (lnaPath != uhf) {
+    tune[n++] = (BK4819_RegWrite_t){BK4819_REG_33, BK4819_SetRXFilterPathState(fMeasure)};
+    lnaPath = uhf;
+  }
+  tune[n++] = (BK4819_RegWrite_t){BK4819_REG_38, tuned & 0xFFFF};
+  if (BK4819_ReadRegister(BK4819_REG_39) != (tuned >> 16))
+    tune[n++] = (BK4819_RegWrite_t){BK4819_REG_39, tuned >> 16};
+  tune[n++] = (BK4819_RegWrite_t){BK4819_REG_30, 0};
+  tune[n++] = (BK4819_RegWrite_t){BK4819_REG_30, reg};
+  BK4819_WriteRegisters(tune, n);
+
+  tuneStart = SYSTICK_GetElapsed();
+  tuneBand = FREQUENCY_GetBand(f);
+  tuneSettling = true;
 }
 
 // Spectrum related
@@ -299,6 +410,23 @@ uint32_t GetFStart() {
 
 uint32_t GetFEnd() { return currentFreq + GetBW(); }
 
+// the part of the range that is on screen
+static uint32_t GetViewFStart() {
+#ifdef ENABLE_SPECTRUM_WIDE_SCAN
+  if (wideCount)
+    return GetFStart() + ((uint32_t)zoomStart << wideTier) * GetScanStep();
+#endif
+  return GetFStart();
+}
+
+static uint32_t GetViewFEnd() {
+#ifdef ENABLE_SPECTRUM_WIDE_SCAN
+  if (wideCount && zoomStart + zoomCount < wideCount)
+    return GetFStart() + ((uint32_t)(zoomStart + zoomCount) << wideTier) * GetScanStep();
+#endif
+  return GetFEnd();
+}
+
 static void TuneToPeak() {
   scanInfo.f = peak.f;
   scanInfo.rssi = peak.rssi;
@@ -355,15 +483,51 @@ uint8_t GetBWRegValueForScan() {
   return scanStepBWRegValues[settings.scanStepIndex];
 }
   
-uint16_t GetRssi() {
-  uint16_t rssi;
-    // SYSTICK_DelayUs(800);
-  // testing autodelay based on Glitch value
+// REG_63 reads 255 until the receiver has settled after a retune. Every poll
+// costs a bus transfer, so wait for the settling time learned for the band
+// first, learn it again when that was too short and otherwise probe a little
+// shorter next time. Without verify the learned time plus a margin is taken
+// on trust and REG_63 is not read at all.
+static void WaitSettled(bool verify) {
+  uint32_t elapsed;
+  bool first = true;
+
+  if (tuneSettling) {
+    uint32_t dwell = settleUs[tuneBand];
+    if (!verify)
+      dwell += dwell / 8;
+
+    elapsed = TuneElapsedUs();
+    if (elapsed < dwell)
+      SYSTICK_DelayUs(dwell - elapsed);
+
+    if (!verify) {
+      tuneSettling = false;
+      return;
+    }
+  }
+
+  for (;;) {
+    elapsed = TuneElapsedUs();
+    if ((BK4819_ReadRegister(0x63) & 0b11111111) < 255)
+      break;
+    first = false;
+    SYSTICK_DelayUs(SETTLE_POLL_US);
+  }
 
-  // testing resolution to sticky squelch issue
-  while ((BK4819_ReadRegister(0x63) & 0b11111111) >= 255) {
-    SYSTICK_DelayUs(100);
+  if (tuneSettling) {
+    tuneSettling = false;
+    if (!first)
+      settleUs[tuneBand] = elapsed < SETTLE_MAX_US ? elapsed : SETTLE_MAX_US;
+    else
+      settleUs[tuneBand] -= settleUs[tuneBand] / 32;
   }
+}
+
+static uint16_t ReadRssi(bool verify) {
+  uint16_t rssi;
+
+  WaitSettled(verify);
   rssi = BK4819_GetRSSI();
  
   #ifdef ENABLE_SPECTRUM_CHANNEL_SCAN
@@ -380,6 +544,10 @@ uint16_t GetRssi() {
   return rssi;
 }
 
+uint16_t GetRssi() {
+  return ReadRssi(true);
+}
+
 static void ToggleAudio(bool on) {
   if (on == audioState) {
     return;
@@ -421,6 +589,12 @@ static void ToggleRX(bool on) {
 
 // Scan info
 
+static void ResetTraces() {
+  memset(traceMax, 0xFF, sizeof(traceMax));
+  memset(traceAvg, 0xFF, sizeof(traceAvg));
+  memset(traceMin, 0xFF, sizeof(traceMin));
+}
+
 static void ResetScanStats() {
   scanInfo.rssi = 0;
   scanInfo.rssiMax = 0;
@@ -430,6 +604,7 @@ static void ResetScanStats() {
 
 static void InitScan() {
   ResetScanStats();
+  prefetched = false;
   scanInfo.i = 0;
   scanInfo.f = GetFStart();
 
@@ -438,6 +613,10 @@ static void InitScan() {
   // prevents phantom channel bar
   if(appMode==CHANNEL_MODE)
     scanInfo.measurementsCount++;
+
+#ifdef ENABLE_SPECTRUM_WIDE_SCAN
+  SetupWideScan();
+#endif
 }
 
 // resets modifiers like blacklist, attenuation, normalization
@@ -464,6 +643,7 @@ static void ResetModifiers() {
 static void RelaunchScan() {
   InitScan();
   ResetPeak();
+  ResetTraces();
   ToggleRX(false);
 #ifdef SPECTRUM_AUTOMATIC_SQUELCH
   settings.rssiTriggerLevel = RSSI_MAX_VALUE;
@@ -509,19 +689,58 @@ static void UpdatePeakInfo() {
     UpdatePeakInfoForce();
 }
 
-static void Measure() 
-{ 
-  uint16_t rssi = scanInfo.rssi = GetRssi();
+static void UpdateTraces(uint8_t i, uint16_t rssi) {
+  // fine tuning reads off the bin's frequency
+  if (currentState == STILL || i >= ARRAY_SIZE(traceAvg))
+    return;
+
+  const uint16_t v = (rssi < 0x0FFF ? rssi : 0x0FFF) << TRACE_FRAC;
+
+  if (traceAvg[i] == TRACE_NONE) {
+    traceMax[i] = traceAvg[i] = traceMin[i] = v;
+    return;
+  }
+
+  if (v >= traceMax[i])
+    traceMax[i] = v;
+  else
+    traceMax[i] -= (traceMax[i] - v) >> TRACE_HOLD_SHIFT;
+
+  if (v <= traceMin[i])
+    traceMin[i] = v;
+  else
+    traceMin[i] += (v - traceMin[i]) >> TRACE_HOLD_SHIFT;
+
+  if (v >= traceAvg[i])
+    traceAvg[i] += (v - traceAvg[i]) >> TRACE_AVG_SHIFT;
+  else
+    traceAvg[i] -= (traceAvg[i] - v) >> TRACE_AVG_SHIFT;
+}
+
+static void SaveRssi(uint16_t rssi)
+{
+  scanInfo.rssi = rssi;
   #ifdef ENABLE_SCAN_RANGES  
     if(scanInfo.measurementsCount > 128) {
+    #ifdef ENABLE_SPECTRUM_WIDE_SCAN
+      SaveWideSample(rssi);
+      return;
+    #endif
       uint8_t idx = CurrentScanIndex();
       if(rssiHistory[idx] < rssi || isListening) 
         rssiHistory[idx] = rssi;
       rssiHistory[(idx+1)%128] = 0;
+      UpdateTraces(idx, rssi);
       return;
     }
   #endif
   rssiHistory[scanInfo.i] = rssi;
+  UpdateTraces(scanInfo.i, rssi);
+}
+
+static void Measure() 
+{ 
+  SaveRssi(GetRssi());
 }
 
 // Update things by keypress
@@ -629,6 +848,11 @@ static void ToggleBacklight() {
   }
 }
 
+static void NextTraceMode() {
+  settings.traceMode = (settings.traceMode + 1) % (TRACE_MIN + 1);
+  redrawScreen = true;
+}
+
 static void ToggleStepsCount() {
   if (settings.stepsCount == STEPS_128) {
     settings.stepsCount = STEPS_16;
@@ -706,9 +930,16 @@ static void UpdateFreqInput(KEY_Code_t key) {
 static void Blacklist() {
 #ifdef ENABLE_SCAN_RANGES
   blacklistFreqs[blacklistFreqsIdx++ % ARRAY_SIZE(blacklistFreqs)] = peak.i;
+#ifdef ENABLE_SPECTRUM_WIDE_SCAN
+  if (wideCount)
+    wideSamples[peak.i >> wideTier] = 0;
+  else
+#endif
   rssiHistory[CurrentScanIndex()] = RSSI_MAX_VALUE;
 #endif
-  rssiHistory[peak.i] = RSSI_MAX_VALUE;
+  // with more than 128 steps the peak's index is past the bins
+  if (peak.i < ARRAY_SIZE(rssiHistory))
+    rssiHistory[peak.i] = RSSI_MAX_VALUE;
   isBlacklistApplied = true;
   ResetPeak();
   ToggleRX(false);
@@ -716,19 +947,24 @@ static void Blacklist() {
 }
 
 #ifdef ENABLE_SCAN_RANGES
-static uint8_t CurrentScanIndex()
+static uint8_t ScanIndex(uint16_t step)
 {
   if(scanInfo.measurementsCount > 128) {
-    uint8_t i = (uint32_t)ARRAY_SIZE(rssiHistory) * 1000 / scanInfo.measurementsCount * scanInfo.i / 1000;
+    uint8_t i = (uint32_t)ARRAY_SIZE(rssiHistory) * 1000 / scanInfo.measurementsCount * step / 1000;
     return i;
   }
   else
   {
-    return scanInfo.i;
+    return step;
   }
   
 }
 
+static uint8_t CurrentScanIndex()
+{
+  return ScanIndex(scanInfo.i);
+}
+
 static bool IsBlacklisted(uint16_t idx)
 {
   for(uint8_t i = 0; i < ARRAY_SIZE(blacklistFreqs); i++)
@@ -738,6 +974,110 @@ static bool IsBlacklisted(uint16_t idx)
 }
 #endif
 
+#ifdef ENABLE_SPECTRUM_WIDE_SCAN
+static void SetupWideScan() {
+  uint8_t tier = 0;
+  uint16_t count = 0;
+
+  if (scanInfo.measurementsCount > 128) {
+    // the last step is measured too
+    while ((scanInfo.measurementsCount >> tier) >= WIDE_SCAN_SAMPLES)
+      tier++;
+    count = (scanInfo.measurementsCount >> tier) + 1;
+  }
+
+  // the same range again keeps the samples and the zoom
+  if (tier == wideTier && count == wideCount)
+    return;
+
+  wideTier = tier;
+  wideCount = count;
+  zoomStart = 0;
+  zoomCount = count;
+  memset(wideSamples, 0, sizeof(wideSamples));
+}
+
+// first column of a sample on screen, -1 when it is zoomed out of view
+static int16_t WideSampleX(uint16_t sample) {
+  if (sample < zoomStart || sample >= zoomStart + zoomCount)
+    return -1;
+  return (uint32_t)(sample - zoomStart) * 128 / zoomCount;
+}
+
+static void SaveWideSample(uint16_t rssi) {
+  const uint16_t sample = scanInfo.i >> wideTier;
+  const uint8_t v = clamp(rssi >> 1, 1, 255);
+
+  // the first step of a sample starts it over, the others keep the strongest
+  if (isListening || (scanInfo.i & ((1 << wideTier) - 1)) == 0 || wideSamples[sample] < v)
+    wideSamples[sample] = v;
+
+  int16_t x = WideSampleX(sample);
+  if (x >= 0)
+    UpdateTraces(x, rssi);
+}
+
+// fills the bins with the strongest sample under each column, min and mean
+// go to their own arrays
+static void DecimateWideScan() {
+  for (uint8_t x = 0; x < 128; ++x) {
+    uint16_t from = zoomStart + (uint32_t)zoomCount * x / 128;
+    uint16_t to = zoomStart + (uint32_t)zoomCount * (x + 1) / 128;
+    uint8_t lo = 255, hi = 0;
+    uint16_t sum = 0, n = 0;
+
+    // zoomed in past a sample per column
+    if (to == from)
+      to++;
+
+    for (uint16_t i = from; i < to; ++i) {
+      uint8_t v = wideSamples[i];
+      if (!v)
+        continue;
+      if (v < lo)
+        lo = v;
+      if (v > hi)
+        hi = v;
+      sum += v;
+      n++;
+    }
+
+    if (!n) {
+      rssiHistory[x] = 0;
+      wideMin[x] = wideMean[x] = 0;
+      continue;
+    }
+    rssiHistory[x] = hi << 1;
+    wideMin[x] = lo;
+    wideMean[x] = sum / n;
+  }
+}
+
+static void ResetZoom() {
+  zoomStart = 0;
+  zoomCount = wideCount;
+}
+
+// halves the window around the peak, from the narrowest back to all of it
+static void ZoomWideScan() {
+  if (!wideCount)
+    return;
+
+  if (zoomCount / 2 < WIDE_SCAN_ZOOM_MIN) {
+    ResetZoom();
+  } else {
+    uint16_t center = peak.i >> wideTier;
+    if (WideSampleX(center) < 0)
+      center = zoomStart + zoomCount / 2;
+    zoomCount /= 2;
+    zoomStart = clamp(center - zoomCount / 2, 0, wideCount - zoomCount);
+  }
+
+  ResetTraces();
+  redrawScreen = true;
+}
+#endif
+
 // Draw things
 
 // applied x2 to prevent initial rounding
@@ -757,7 +1097,30 @@ uint8_t Rssi2Y(uint16_t rssi) {
   return DrawingEndY - Rssi2PX(rssi, 0, DrawingEndY);
 }
 
+#ifdef ENABLE_SPECTRUM_WIDE_SCAN
+// solid up to the mean of the column, dotted up to its strongest sample and
+// the weakest one cut into the bar
+static void DrawWideScan() {
+  for (uint8_t x = 0; x < 128; ++x) {
+    if (!rssiHistory[x])
+      continue;
+    uint8_t yMean = Rssi2Y(wideMean[x] << 1);
+    DrawVLine(yMean, DrawingEndY, x, true);
+    for (uint8_t y = Rssi2Y(rssiHistory[x]); y < yMean; y += 2)
+      PutPixel(x, y, true);
+    if (wideMin[x] < wideMean[x])
+      PutPixel(x, Rssi2Y(wideMin[x] << 1), false);
+  }
+}
+#endif
+
 static void DrawSpectrum() {
+#ifdef ENABLE_SPECTRUM_WIDE_SCAN
+  if (wideCount) {
+    DrawWideScan();
+    return;
+  }
+#endif
   for (uint8_t x = 0; x < 128; ++x) {
     uint16_t rssi = rssiHistory[x >> settings.stepsCount];
     if (rssi != RSSI_MAX_VALUE) {
@@ -766,6 +1129,151 @@ static void DrawSpectrum() {
   }
 }
 
+static void DrawTrace() {
+  const uint16_t *trace;
+
+  switch (settings.traceMode) {
+  case TRACE_MAX:
+    trace = traceMax;
+    break;
+  case TRACE_AVG:
+    trace = traceAvg;
+    break;
+  case TRACE_MIN:
+    trace = traceMin;
+    break;
+  default:
+    return;
+  }
+
+  const uint8_t w = 1 << settings.stepsCount;
+
+  for (uint8_t i = 0; i < 128 >> settings.stepsCount; ++i) {
+    if (rssiHistory[i] == RSSI_MAX_VALUE || trace[i] == TRACE_NONE) {
+      continue;
+    }
+    uint8_t y = Rssi2Y((trace[i] + (1 << (TRACE_FRAC - 1))) >> TRACE_FRAC);
+    // dark over the bars' background, light where it runs inside a bar
+    bool black = y <= Rssi2Y(rssiHistory[i]);
+    UI_DrawDottedLineBuffer(gFrameBuffer, i * w, y, i * w + w - 1, y, black, 2);
+  }
+
+  GUI_DisplaySmallest(traceModeNames[settings.traceMode], 0, 13, false, true);
+}
+
+#ifdef ENABLE_SPECTRUM_WATERFALL
+static uint8_t WaterfallLevel(uint16_t rssi) {
+  return rssi == RSSI_MAX_VALUE ? 0 : Rssi2PX(rssi, 0, 15);
+}
+
+static void DrawWaterfallRow(uint8_t slot, uint8_t y) {
+  const uint8_t *row = waterfall[slot];
+  const uint8_t *threshold = waterfallDither[slot & 3];
+  uint8_t *line = waterfallImage[y >> 3];
+  const uint8_t bit = 1 << (y & 7);
+
+  for (uint8_t x = 0; x < 128; ++x) {
+    uint8_t level = (row[x >> 1] >> ((x & 1) << 2)) & 0x0F;
+    if (level > threshold[x & 3]) {
+      line[x] |= bit;
+    } else {
+      line[x] &= ~bit;
+    }
+  }
+}
+
+static void RedrawWaterfall() {
+  memset(waterfallImage, 0, sizeof(waterfallImage));
+  for (uint8_t y = 0; y < WATERFALL_VISIBLE; ++y) {
+    uint8_t age = waterfallOffset + y;
+    if (age >= waterfallCount) {
+      break;
+    }
+    DrawWaterfallRow((waterfallHead + WATERFALL_ROWS - age) % WATERFALL_ROWS, y);
+  }
+}
+
+static void AddWaterfallRow() {
+  if (waterfallFrozen) {
+    return;
+  }
+
+  waterfallHead = (waterfallHead + 1) % WATERFALL_ROWS;
+  if (waterfallCount < WATERFALL_ROWS) {
+    waterfallCount++;
+  }
+
+  uint8_t *row = waterfall[waterfallHead];
+  for (uint8_t x = 0; x < 128; x += 2) {
+    row[x >> 1] = WaterfallLevel(rssiHistory[x >> settings.stepsCount]) |
+                  WaterfallLevel(rssiHistory[(x + 1) >> settings.stepsCount]) << 4;
+  }
+
+  // move the image one pixel down, bit 7 of a page carries into the next one
+  for (uint8_t x = 0; x < 128; ++x) {
+    uint8_t carry = 0;
+    for (uint8_t p = 0; p < WATERFALL_PAGES; ++p) {
+      uint8_t b = waterfallImage[p][x];
+      waterfallImage[p][x] = (b << 1) | carry;
+      carry = b >> 7;
+    }
+  }
+  DrawWaterfallRow(waterfallHead, 0);
+}
+
+static void ResetWaterfall() {
+  waterfallHead = 0;
+  waterfallCount = 0;
+  waterfallOffset = 0;
+  waterfallFrozen = false;
+  memset(waterfallImage, 0, sizeof(waterfallImage));
+}
+
+static void ToggleWaterfall() {
+  waterfallView = !waterfallView;
+  redrawScreen = true;
+}
+
+static void FreezeWaterfall(bool freeze) {
+  waterfallFrozen = freeze;
+  if (!freeze && waterfallOffset) {
+    waterfallOffset = 0;
+    RedrawWaterfall();
+  }
+  redrawScreen = true;
+}
+
+static void ScrollWaterfall(bool older) {
+  if (older) {
+    if (waterfallOffset + WATERFALL_VISIBLE >= waterfallCount) {
+      return;
+    }
+    waterfallOffset++;
+  } else {
+    if (!waterfallOffset) {
+      return;
+    }
+    waterfallOffset--;
+  }
+  // rows coming in at the top would shift what is being looked at
+  waterfallFrozen = true;
+  RedrawWaterfall();
+  redrawScreen = true;
+}
+
+static void DrawWaterfallState() {
+  if (!waterfallFrozen) {
+    return;
+  }
+  if (waterfallOffset) {
+    sprintf(String, "-%u", waterfallOffset);
+  } else {
+    sprintf(String, "FRZ");
+  }
+  GUI_DisplaySmallest(String, 80, 49, false, true);
+}
+#endif
+
 static void DrawStatus() {
 #ifdef SPECTRUM_EXTRA_VALUES
   sprintf(String, "%d/%d P:%d T:%d", settings.dbMin, settings.dbMax,
@@ -777,11 +1285,11 @@ static void DrawStatus() {
   }
   else
   {
-    sprintf(String, "%d/%d", settings.dbMin, settings.dbMax);
+    sprintf(String, "%d/%d %u.%u/s", settings.dbMin, settings.dbMax, sweepRate / 10, sweepRate % 10);
   }
   
 #else
-  sprintf(String, "%d/%d", settings.dbMin, settings.dbMax);
+  sprintf(String, "%d/%d %u.%u/s", settings.dbMin, settings.dbMax, sweepRate / 10, sweepRate % 10);
 #endif
   GUI_DisplaySmallest(String, 0, 1, true, true);
 
@@ -825,12 +1333,13 @@ static void DrawF(uint32_t f) {
     
     lastPeakFrequency = peak.f;
     
-    channel = BOARD_gMR_fetchChannel(peak.f);
+    // a channel inside the peak's bin is what is being heard
+    channel = BOARD_gMR_fetchChannel(peak.f, GetScanStep() / 2);
 
     isKnownChannel = channel == -1 ? false : true;
 
     if (isKnownChannel){
-      memmove(channelName, gMR_ChannelFrequencyAttributes[channel].Name, sizeof(channelName));
+      memmove(channelName, BOARD_gMR_ChannelName(channel), sizeof(channelName));
     }
 
     redrawStatus = true;
@@ -839,13 +1348,21 @@ static void DrawF(uint32_t f) {
 
 static void DrawNums() {
 
-  if (currentState == SPECTRUM) {
+  if (currentState == SPECTRUM
+#ifdef ENABLE_SPECTRUM_WATERFALL
+      && !waterfallView
+#endif
+  ) {
     if(isNormalizationApplied){
       sprintf(String, "N(%ux)", GetStepsCount());
     }
     else {
       sprintf(String, "%ux", GetStepsCount());
     }
+#ifdef ENABLE_SPECTRUM_WIDE_SCAN
+    if (zoomCount < wideCount)
+      sprintf(String + strlen(String), " Z%u", wideCount / zoomCount);
+#endif
     GUI_DisplaySmallest(String, 0, 1, false, true);
 
     if (appMode==CHANNEL_MODE)
@@ -871,10 +1388,10 @@ static void DrawNums() {
   }
   else
   {
-    sprintf(String, "%u.%05u", GetFStart() / 100000, GetFStart() % 100000);
+    sprintf(String, "%u.%05u", GetViewFStart() / 100000, GetViewFStart() % 100000);
     GUI_DisplaySmallest(String, 0, 49, false, true);
 
-    sprintf(String, "%u.%05u", GetFEnd() / 100000, GetFEnd() % 100000);
+    sprintf(String, "%u.%05u", GetViewFEnd() / 100000, GetViewFEnd() % 100000);
     GUI_DisplaySmallest(String, 93, 49, false, true);
   }
 
@@ -899,11 +1416,11 @@ static void DrawRssiTriggerLevel() {
 }
 
 static void DrawTicks() {
-  uint32_t f = GetFStart();
-  uint32_t span = GetFEnd() - GetFStart();
+  uint32_t f = GetViewFStart();
+  uint32_t span = GetViewFEnd() - GetViewFStart();
   uint32_t step = span / 128;
   for (uint8_t i = 0; i < 128; i += (1 << settings.stepsCount)) {
-    f = GetFStart() + span * i / 128;
+    f = GetViewFStart() + span * i / 128;
     uint8_t barValue = 0b00000001;
     (f % 10000) < step && (barValue |= 0b00000010);
     (f % 50000) < step && (barValue |= 0b00000100);
@@ -927,6 +1444,18 @@ static void DrawArrow(uint8_t x) {
   }
 }
 
+static void OnKey8Up() {
+  if (!traceKeyHeld) {
+#ifdef ENABLE_SPECTRUM_WATERFALL
+    ToggleWaterfall();
+#else
+    ToggleBacklight();
+#endif
+  }
+  traceKeyDown = false;
+  traceKeyHeld = false;
+}
+
 static void OnKeyDown(uint8_t key) {
   switch (key) {
   case KEY_3:
@@ -951,7 +1480,13 @@ static void OnKeyDown(uint8_t key) {
     ToggleNormalizeRssi(!isNormalizationApplied);
     break;
   case KEY_8:
-    ToggleBacklight();
+    // the tap waits for the release (OnKey8Up), so a hold can step the
+    // trace mode instead without a flicker
+    if (kbd.counter == 16 && !traceKeyHeld) {
+      traceKeyHeld = true;
+      NextTraceMode();
+    }
+    traceKeyDown = true;
     break;
   case KEY_UP:
 #ifdef ENABLE_SCAN_RANGES
@@ -1007,6 +1542,12 @@ static void OnKeyDown(uint8_t key) {
     {
       ToggleStepsCount();
     }
+#ifdef ENABLE_SPECTRUM_WIDE_SCAN
+    else
+    {
+      ZoomWideScan();
+    }
+#endif
     break;
   case KEY_SIDE2:
     Attenuate(ATTENUATE_STEP);
@@ -1037,6 +1578,32 @@ static void OnKeyDown(uint8_t key) {
   }
 }
 
+#ifdef ENABLE_SPECTRUM_WATERFALL
+// keys the waterfall view takes over, the rest work as in the spectrum
+static bool OnKeyDownWaterfall(uint8_t key) {
+  switch (key) {
+  case KEY_UP:
+    ScrollWaterfall(true);
+    break;
+  case KEY_DOWN:
+    ScrollWaterfall(false);
+    break;
+  case KEY_SIDE1:
+    FreezeWaterfall(!waterfallFrozen);
+    break;
+  case KEY_SIDE2:
+    ToggleBacklight();
+    break;
+  case KEY_EXIT:
+    ToggleWaterfall();
+    break;
+  default:
+    return false;
+  }
+  return true;
+}
+#endif
+
 static void OnKeyDownFreqInput(uint8_t key) {
   switch (key) {
   case KEY_0:
@@ -1157,7 +1724,20 @@ static void RenderStatus() {
 }
 
 static void RenderSpectrum() {
+#ifdef ENABLE_SPECTRUM_WIDE_SCAN
+  if (wideCount)
+    DecimateWideScan();
+#endif
   DrawTicks();
+#ifdef ENABLE_SPECTRUM_WIDE_SCAN
+  if (wideCount)
+  {
+    int16_t x = WideSampleX(peak.i >> wideTier);
+    if (x >= 0)
+      DrawArrow(x);
+  }
+  else
+#endif
   if((appMode==CHANNEL_MODE)&&(GetStepsCount()<128u))
   {
     DrawArrow(peak.i * (settings.stepsCount + 1));
@@ -1166,8 +1746,17 @@ static void RenderSpectrum() {
   {
     DrawArrow(128u * peak.i / GetStepsCount());
   }
-  DrawSpectrum();
-  DrawRssiTriggerLevel();
+#ifdef ENABLE_SPECTRUM_WATERFALL
+  if (waterfallView) {
+    memcpy(gFrameBuffer[WATERFALL_PAGE], waterfallImage, sizeof(waterfallImage));
+    DrawWaterfallState();
+  } else
+#endif
+  {
+    DrawSpectrum();
+    DrawTrace();
+    DrawRssiTriggerLevel();
+  }
   DrawF(peak.f);
   DrawNums();
 }
@@ -1274,9 +1863,17 @@ bool HandleUserInput() {
     kbd.counter = 0;
   }
 
+  if (traceKeyDown && kbd.current != KEY_8) {
+    OnKey8Up();
+  }
+
   if (kbd.counter == 3 || kbd.counter == 16) {
     switch (currentState) {
     case SPECTRUM:
+#ifdef ENABLE_SPECTRUM_WATERFALL
+      if (waterfallView && OnKeyDownWaterfall(kbd.current))
+        break;
+#endif
       OnKeyDown(kbd.current);
       break;
     case FREQ_INPUT:
@@ -1291,42 +1888,89 @@ bool HandleUserInput() {
   return true;
 }
 
-static void Scan() {
-  if (rssiHistory[scanInfo.i] != RSSI_MAX_VALUE
+static bool IsScanned(uint16_t i) {
+  // past 128 steps there is no bin of its own to mark
+  return (i >= ARRAY_SIZE(rssiHistory) || rssiHistory[i] != RSSI_MAX_VALUE)
 #ifdef ENABLE_SCAN_RANGES
-  && !IsBlacklisted(scanInfo.i)
+  && !IsBlacklisted(i)
 #endif
-  ) {
-    SetF(scanInfo.f);
-    Measure();
-    UpdateScanInfo();
-  }
+  ;
 }
 
-static void NextScanStep() {
-  ++peak.t;
+static uint32_t NextScanFrequency() {
   #ifdef ENABLE_SPECTRUM_CHANNEL_SCAN
     // channel mode
     if (appMode==CHANNEL_MODE)
-    {
-      int currentChannel = scanChannel[scanInfo.i];
-      scanInfo.f =  gMR_ChannelFrequencyAttributes[currentChannel].Frequency;
-      ++scanInfo.i; 
-    }
-    else
-    // frequency mode
-    {
-      ++scanInfo.i; 
-      scanInfo.f += scanInfo.scanStep;
-    }
-    
-  #elif
-    ++scanInfo.i;
-    scanInfo.f += scanInfo.scanStep;
+      return BOARD_gMR_ChannelFrequency(scanChannel[scanInfo.i]);
   #endif
+  // frequency mode
+  return scanInfo.f + scanInfo.scanStep;
+}
+
+static void Scan() {
+  if (IsScanned(scanInfo.i)) {
+    uint16_t rssi;
 
+    // a retune to the next step settles the same way every time, so only
+    // every 8th needs checking, the others rely on the learned time
+    bool verify = !prefetched || fMeasure != scanInfo.f || (scanInfo.i % 8) == 0;
+
+    if (!prefetched || fMeasure != scanInfo.f)
+      SetF(scanInfo.f);
+    prefetched = false;
+
+    rssi = ReadRssi(verify);
+
+    // tune the next step right away, it settles while this one is stored
+    if (scanInfo.i < GetStepsCount() && IsScanned(scanInfo.i + 1)) {
+      SetF(NextScanFrequency());
+      prefetched = true;
+    }
+
+    SaveRssi(rssi);
+    UpdateScanInfo();
+  }
 }
 
+static void NextScanStep() {
+  ++peak.t;
+  scanInfo.f = prefetched ? fMeasure : NextScanFrequency();
+  ++scanInfo.i;
+}
+
+static void CountSweep() {
+  const uint32_t ticks = SCHEDULER_GetTicks() - sweepWindowStart;
+
+  sweepsInWindow++;
+  if (ticks >= 100) {
+    sweepRate = sweepsInWindow * 1000u / ticks;
+    sweepsInWindow = 0;
+    sweepWindowStart += ticks;
+    redrawStatus = true;
+  }
+}
+
+#ifdef ENABLE_SPECTRUM_UART
+// hands the finished sweep to the UART, which drops it if the link is busy
+static void SendSweep() {
+  uint16_t bins = scanInfo.measurementsCount;
+  uint32_t step = scanInfo.scanStep;
+
+  if (appMode == CHANNEL_MODE) {
+    bins = GetStepsCount();
+    step = 0;
+  } else if (bins > 128) {
+    // each bin holds the highest of several steps
+    step = (GetViewFEnd() - GetViewFStart()) / 128;
+  }
+
+  if (bins > 128)
+    bins = 128;
+
+  UART_SendSpectrum(GetViewFStart(), step, rssiHistory, bins);
+}
+#endif
+
 static void UpdateScan() {
   Scan();
 
@@ -1341,6 +1985,20 @@ static void UpdateScan() {
 
   redrawScreen = true;
   preventKeypress = false;
+  CountSweep();
+
+#ifdef ENABLE_SPECTRUM_WIDE_SCAN
+  if (wideCount)
+    DecimateWideScan();
+#endif
+
+#ifdef ENABLE_SPECTRUM_WATERFALL
+  AddWaterfallRow();
+#endif
+
+#ifdef ENABLE_SPECTRUM_UART
+  SendSweep();
+#endif
 
   UpdatePeakInfo();
   if (IsPeakOverLevel()) {
@@ -1399,10 +2057,13 @@ static void UpdateListening() {
 
 static void Tick() {
 
-#ifdef ENABLE_SCAN_RANGES
   if (gNextTimeslice_500ms) {
     gNextTimeslice_500ms = false;
 
+    // the main loop's 500ms slice doesn't run while we are here
+    ST7565_TimeSlice500ms();
+
+#ifdef ENABLE_SCAN_RANGES
     // if a lot of steps then it takes long time
     // we don't want to wait for whole scan
     // listening has it's own timer
@@ -1416,8 +2077,8 @@ static void Tick() {
       redrawScreen = true;
       preventKeypress = false;
     }
-  }
 #endif
+  }
 
   if (!preventKeypress) {
     HandleUserInput();
@@ -1479,6 +2140,22 @@ void APP_RunSpectrum() {
 
   currentFreq = initialFreq = gTxVfo->pRX->Frequency;
 
+  // the main loop doesn't run while we are here
+  EEPROM_Flush();
+
+  lnaPath = -1;
+  ResetTraces();
+#ifdef ENABLE_SPECTRUM_WIDE_SCAN
+  wideCount = 0;
+#endif
+  sweepWindowStart = SCHEDULER_GetTicks();
+  sweepsInWindow = 0;
+  sweepRate = 0;
+
+#ifdef ENABLE_SPECTRUM_WATERFALL
+  ResetWaterfall();
+#endif
+
   BackupRegisters();
 
   ResetInterrupts();
@@ -1576,6 +2253,13 @@ void APP_RunSpectrum() {
       return;
 
     if(on) {
+#ifdef ENABLE_SPECTRUM_WIDE_SCAN
+      // the offsets go by 1/128 of the whole range
+      if (wideCount) {
+        ResetZoom();
+        DecimateWideScan();
+      }
+#endif
       for(uint8_t i = 0; i < ARRAY_SIZE(rssiHistory); i++)
       {
         gainOffset[i] = peak.rssi - rssiHistory[i];
@@ -1591,14 +2275,21 @@ void APP_RunSpectrum() {
 
   void Attenuate(uint8_t amount)
   {
+    uint16_t i = peak.i;
+
     // attenuate doesn't work with more than 128 samples,
     // since we select max rssi in such mode ignoring attenuation
      if(scanInfo.measurementsCount > 128)
+#ifdef ENABLE_SPECTRUM_WIDE_SCAN
+      // the steps are kept apart, attenuate the peak's 1/128 of the range
+      i = ScanIndex(peak.i);
+#else
       return;
+#endif
 
     // idea: consider amount to be 10% of rssiMax-rssiMin
-    if(attenuationOffset[peak.i] < MAX_ATTENUATION){
-      attenuationOffset[peak.i] += amount;
+    if(attenuationOffset[i] < MAX_ATTENUATION){
+      attenuationOffset[i] += amount;
       isAttenuationApplied = true;
 
       ResetPeak();
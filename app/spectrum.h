@@ -22,6 +22,7 @@
 #include "../bsp/dp32g030/gpio.h"
 #include "../driver/bk4819-regs.h"
 #include "../driver/bk4819.h"
+#include "../driver/eeprom.h"
 #include "../driver/gpio.h"
 #include "../driver/keyboard.h"
 #include "../driver/st7565.h"
@@ -123,6 +124,13 @@ typedef enum ScanStep {
   S_STEP_100_0kHz,
 } ScanStep;
 
+typedef enum TraceMode {
+  TRACE_OFF,
+  TRACE_MAX,
+  TRACE_AVG,
+  TRACE_MIN,
+} TraceMode;
+
 typedef enum ScanList {
   S_SCAN_LIST_1,
   S_SCAN_LIST_2,
@@ -142,6 +150,7 @@ typedef struct SpectrumSettings {
   ModulationMode_t modulationType;
   bool backlightState;
   int scanList;
+  TraceMode traceMode;
 } SpectrumSettings;
 
 typedef struct KeyboardState {
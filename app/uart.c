@@ -140,6 +140,94 @@ typedef struct {
 	uint32_t Timestamp;
 } CMD_052F_t;
 
+typedef struct {
+	Header_t Header;
+	uint32_t BaudRate;
+	uint32_t Timestamp;
+} CMD_0531_t;
+
+typedef struct {
+	Header_t Header;
+	uint16_t Offset;
+	uint16_t Length;
+	uint8_t  Window;
+	bool     bRle;
+	uint8_t  Padding[2];
+	uint32_t Timestamp;
+} CMD_0533_t;
+
+typedef struct {
+	Header_t Header;
+	struct {
+		uint16_t Offset;
+		uint16_t Size;     // bytes once decoded
+		uint8_t  Data[128];
+	} Data;
+} REPLY_0536_t;
+
+typedef struct {
+	Header_t Header;
+	uint16_t Offset;
+	uint16_t Size;         // bytes once decoded
+	bool     bAllowPassword;
+	uint8_t  Padding[3];
+	uint32_t Timestamp;
+	uint8_t  Data[0];
+} CMD_0539_t;
+
+typedef struct {
+	Header_t Header;
+	uint16_t Offset;
+	uint8_t  Padding[2];
+	uint32_t Timestamp;
+} CMD_0535_t;
+
+typedef struct {
+	Header_t Header;
+	struct {
+		uint32_t BaudRate;
+		bool     bAccepted;
+		uint8_t  Padding[3];
+	} Data;
+} REPLY_0532_t;
+
+typedef struct {
+	Header_t Header;
+	uint8_t  Interval_10ms;    // 0 stops the telemetry
+	uint8_t  Padding[3];
+	uint32_t Timestamp;
+} CMD_053A_t;
+
+typedef struct {
+	Header_t Header;
+	struct {
+		uint8_t Interval_10ms;
+		uint8_t Padding[3];
+	} Data;
+} REPLY_053B_t;
+
+#ifdef ENABLE_SPECTRUM_UART
+typedef struct {
+	Header_t Header;
+	struct {
+		uint32_t Frequency;    // of the first bin, 10 Hz units
+		uint32_t Step;         // between bins, 0 when they are memory channels
+		uint16_t Sequence;
+		uint8_t  Bins;
+		uint8_t  Padding;
+		uint8_t  Rssi[228];    // 252 bytes with the frame, the TX ring holds 255
+	} Data;
+} REPLY_053D_t;
+#endif
+
+typedef struct {
+	uint16_t Sequence;
+	uint16_t Tick_10ms;
+	uint16_t RSSI;
+	uint8_t  ExNoiseIndicator;
+	uint8_t  GlitchIndicator;
+} TelemetryRecord_t;
+
 static const uint8_t Obfuscation[16] =
 {
 	0x16, 0x6C, 0x14, 0xE6, 0x2E, 0x91, 0x0D, 0x40, 0x21, 0x35, 0xD5, 0x40, 0x13, 0x03, 0xE9, 0x80
@@ -155,11 +243,95 @@ static union
 	};
 } UART_Command;
 
+static const uint32_t BaudRates[] = { 38400, 115200, 230400, 460800 };
+
 static uint32_t Timestamp;
 static uint16_t gUART_WriteIndex;
 static bool     bIsEncrypted = true;
+static uint32_t gUART_BaudRate = UART_BAUD_RATE_DEFAULT;
+static uint8_t  gUART_BaudConfirmCountdown_500ms;
+
+// Streamed EEPROM read: frames go out back to back as long as less than
+// Window frames are waiting for an acknowledge
+#define STREAM_FRAME_SIZE      128U
+#define STREAM_WINDOW_MAX      8U
+#define STREAM_TIMEOUT_10ms    100U    // resend what wasn't acknowledged
+
+// EEPROM bytes read per 10 ms tick. The bit-banged I2C takes about 40 us a
+// byte, so this keeps a tick's reading to about 5 ms.
+#define STREAM_BYTES_PER_TICK  128U
+
+// RLE frames are filled from blocks of this size. A frame covers at most
+// RLE_FRAME_RAW bytes of EEPROM, the same as a plain frame, whichever way
+// it goes.
+#define RLE_BLOCK_SIZE         64U
+#define RLE_FRAME_RAW          128U
+
+static struct {
+	uint16_t Sent;     // next byte to send
+	uint16_t Acked;    // the host has everything below
+	uint16_t End;
+	uint16_t FrameEnd[STREAM_WINDOW_MAX];  // of the unacknowledged frames, oldest first
+	uint8_t  Frames;
+	uint8_t  Window;
+	uint8_t  Countdown_10ms;
+	bool     bRle;
+} gStream;
+
+// Telemetry records wait here until there is room in the TX ring, when the
+// link can't keep up the oldest ones go (the host sees the sequence skip)
+#define TELEMETRY_RECORDS      16U
+
+static struct {
+	struct {
+		Header_t          Header;
+		uint16_t          DutyCycle;    // share of the last 500ms the core was awake, in 0.1%
+		TelemetryRecord_t Records[TELEMETRY_RECORDS];
+	} Reply;
+	uint8_t  Count;
+	uint8_t  Interval_10ms;
+	uint8_t  Countdown_10ms;
+	uint16_t Sequence;
+	uint16_t Tick_10ms;
+} gTelemetry;
+
+#ifdef ENABLE_SPECTRUM_UART
+static uint16_t gSpectrumSequence;
+#endif
 
-static void SendReply(void *pReply, uint16_t Size)
+// ID of the write frame in UART_Command still to be written, 0 if none
+static uint16_t gStreamWritePending;
+
+// Commands are picked up a byte at a time as they arrive, deobfuscated
+// straight from the DMA ring into UART_Command with the CRC kept up to date
+typedef enum {
+	PARSER_SYNC0,
+	PARSER_SYNC1,
+	PARSER_SIZE0,
+	PARSER_SIZE1,
+	PARSER_PAYLOAD,      // payload and CRC
+	PARSER_FOOTER0,
+	PARSER_FOOTER1,
+#if defined(ENABLE_MESSENGER) && defined(ENABLE_MESSENGER_UART)
+	PARSER_SMS_M,
+	PARSER_SMS_S,
+	PARSER_SMS_COLON,
+	PARSER_SMS_TEXT,
+#endif
+} ParserState_t;
+
+static struct {
+	ParserState_t State;
+	uint16_t      Start;     // DMA index of the 0xAB
+	uint16_t      Size;
+	uint16_t      Index;     // into UART_Command
+	uint16_t      CrcIndex;  // UART_Command below this is in Crc
+	uint16_t      Crc;
+	bool          bEncrypted;
+} gParser;
+
+// The stock replies leave the CRC out (0xFFFF), streamed frames carry it
+static void SendFrame(void *pReply, uint16_t Size, uint16_t Crc)
 {
 	Header_t Header;
 	Footer_t Footer;
@@ -177,21 +349,28 @@ static void SendReply(void *pReply, uint16_t Size)
 	UART_Send(&Header, sizeof(Header));
 	UART_Send(pReply, Size);
 
+	Footer.Padding[0] = (Crc >> 0) & 0xFF;
+	Footer.Padding[1] = (Crc >> 8) & 0xFF;
 	if (bIsEncrypted)
 	{
-		Footer.Padding[0] = Obfuscation[(Size + 0) % 16] ^ 0xFF;
-		Footer.Padding[1] = Obfuscation[(Size + 1) % 16] ^ 0xFF;
-	}
-	else
-	{
-		Footer.Padding[0] = 0xFF;
-		Footer.Padding[1] = 0xFF;
+		Footer.Padding[0] ^= Obfuscation[(Size + 0) % 16];
+		Footer.Padding[1] ^= Obfuscation[(Size + 1) % 16];
 	}
 	Footer.ID = 0xBADC;
 
 	UART_Send(&Footer, sizeof(Footer));
 }
 
+static void SendReply(void *pReply, uint16_t Size)
+{
+	SendFrame(pReply, Size, 0xFFFF);
+}
+
+static void SendReplyWithCrc(void *pReply, uint16_t Size)
+{
+	SendFrame(pReply, Size, CRC_Calculate(pReply, Size));
+}
+
 static void SendVersion(void)
 {
 	REPLY_0514_t Reply;
@@ -219,7 +398,7 @@ static void CMD_0514(const uint8_t *pBuffer)
 		gFmRadioCountdown_500ms = fm_radio_countdown_500ms;
 	#endif
 
-	gSerialConfigCountDown_500ms = 12; // 6 sec
+	SCHEDULER_TimerArm500ms(&gSerialConfigTimer, 12); // 6 sec
 
 	// turn the LCD backlight off
 	BACKLIGHT_TurnOff();
@@ -236,7 +415,7 @@ static void CMD_051B(const uint8_t *pBuffer)
 	if (pCmd->Timestamp != Timestamp)
 		return;
 
-	gSerialConfigCountDown_500ms = 12; // 6 sec
+	SCHEDULER_TimerArm500ms(&gSerialConfigTimer, 12); // 6 sec
 
 	#ifdef ENABLE_FMRADIO
 		gFmRadioCountdown_500ms = fm_radio_countdown_500ms;
@@ -257,48 +436,62 @@ static void CMD_051B(const uint8_t *pBuffer)
 	SendReply(&Reply, pCmd->Size + 8);
 }
 
-static void CMD_051D(const uint8_t *pBuffer)
+static void WriteEeprom(uint16_t Address, const uint8_t *pData, uint16_t Size, bool bAllowPassword)
 {
-	const CMD_051D_t *pCmd = (const CMD_051D_t *)pBuffer;
-	REPLY_051D_t Reply;
-	bool bReloadEeprom;
+	bool bReloadEeprom = false;
 	bool bIsLocked;
 
-	if (pCmd->Timestamp != Timestamp)
-		return;
-
-	gSerialConfigCountDown_500ms = 12; // 6 sec
-
-	bReloadEeprom = false;
-
-	#ifdef ENABLE_FMRADIO
-		gFmRadioCountdown_500ms = fm_radio_countdown_500ms;
-	#endif
-
-	Reply.Header.ID   = 0x051E;
-	Reply.Header.Size = sizeof(Reply.Data);
-	Reply.Data.Offset = pCmd->Offset;
-
 	bIsLocked = bHasCustomAesKey ? gIsLocked : bHasCustomAesKey;
 
 	if (!bIsLocked)
 	{
 		unsigned int i;
-		for (i = 0; i < (pCmd->Size / 8); i++)
+		unsigned int Start = 0;
+
+		// consecutive blocks go out as one write so the EEPROM can take whole pages
+		for (i = 0; i < (Size / 8); i++)
 		{
-			const uint16_t Offset = pCmd->Offset + (i * 8U);
+			const uint16_t Offset = Address + (i * 8U);
 
 			if (Offset >= 0x0F30 && Offset < 0x0F40)
 				if (!gIsLocked)
 					bReloadEeprom = true;
 
-			if ((Offset < 0x0E98 || Offset >= 0x0EA0) || !bIsInLockScreen || pCmd->bAllowPassword)
-				EEPROM_WriteBuffer(Offset, &pCmd->Data[i * 8U], true);
+			if ((Offset >= 0x0E98 && Offset < 0x0EA0) && bIsInLockScreen && !bAllowPassword)
+			{
+				if (i > Start)
+					EEPROM_WriteBlock(Address + (Start * 8U), &pData[Start * 8U], (i - Start) * 8U, true);
+				Start = i + 1;
+			}
 		}
 
+		if (i > Start)
+			EEPROM_WriteBlock(Address + (Start * 8U), &pData[Start * 8U], (i - Start) * 8U, true);
+
 		if (bReloadEeprom)
 			BOARD_EEPROM_Init();
 	}
+}
+
+static void CMD_051D(const uint8_t *pBuffer)
+{
+	const CMD_051D_t *pCmd = (const CMD_051D_t *)pBuffer;
+	REPLY_051D_t Reply;
+
+	if (pCmd->Timestamp != Timestamp)
+		return;
+
+	SCHEDULER_TimerArm500ms(&gSerialConfigTimer, 12); // 6 sec
+
+	#ifdef ENABLE_FMRADIO
+		gFmRadioCountdown_500ms = fm_radio_countdown_500ms;
+	#endif
+
+	WriteEeprom(pCmd->Offset, pCmd->Data, pCmd->Size, pCmd->bAllowPassword);
+
+	Reply.Header.ID   = 0x051E;
+	Reply.Header.Size = sizeof(Reply.Data);
+	Reply.Data.Offset = pCmd->Offset;
 
 	SendReply(&Reply, sizeof(Reply));
 }
@@ -353,7 +546,7 @@ static void CMD_052F(const uint8_t *pBuffer)
 	if (gCurrentFunction == FUNCTION_POWER_SAVE)
 		FUNCTION_Select(FUNCTION_FOREGROUND);
 
-	gSerialConfigCountDown_500ms = 12; // 6 sec
+	SCHEDULER_TimerArm500ms(&gSerialConfigTimer, 12); // 6 sec
 
 	Timestamp = pCmd->Timestamp;
 
@@ -363,123 +556,646 @@ static void CMD_052F(const uint8_t *pBuffer)
 	SendVersion();
 }
 
-bool UART_IsCommandAvailable(void)
+// Switches the link to a faster rate. The reply still goes out at the old
+// rate, then the radio switches and the host has about a second to send any
+// valid command at the new one (sending 0x0531 again is the usual way),
+// otherwise the radio goes back to the default rate. It also does so when the
+// programming session times out, so the next session starts at 38400 again.
+static void CMD_0531(const uint8_t *pBuffer)
 {
-	uint16_t Index;
-	uint16_t TailIndex;
-	uint16_t Size;
-	uint16_t CRC;
-	uint16_t CommandLength;
-	uint16_t DmaLength = DMA_CH0->ST & 0xFFFU;
+	const CMD_0531_t *pCmd = (const CMD_0531_t *)pBuffer;
+	REPLY_0532_t      Reply;
+	unsigned int      i;
 
-	while (1)
-	{
-		if (gUART_WriteIndex == DmaLength)
+	if (pCmd->Timestamp != Timestamp)
+		return;
+
+	SCHEDULER_TimerArm500ms(&gSerialConfigTimer, 12); // 6 sec
+
+	Reply.Header.ID      = 0x0532;
+	Reply.Header.Size    = sizeof(Reply.Data);
+	Reply.Data.BaudRate  = pCmd->BaudRate;
+	Reply.Data.bAccepted = false;
+	memset(Reply.Data.Padding, 0, sizeof(Reply.Data.Padding));
+
+	for (i = 0; i < ARRAY_SIZE(BaudRates); i++)
+		if (BaudRates[i] == pCmd->BaudRate)
+			Reply.Data.bAccepted = true;
+
+	SendReply(&Reply, sizeof(Reply));
+
+	if (!Reply.Data.bAccepted)
+		return;
+
+	// 38400 means the default divider, whatever the host asks for
+	gUART_BaudRate = (pCmd->BaudRate == BaudRates[0]) ? UART_BAUD_RATE_DEFAULT : pCmd->BaudRate;
+	UART_SetBaudRate(gUART_BaudRate);
+
+	if (gUART_BaudRate != UART_BAUD_RATE_DEFAULT)
+		gUART_BaudConfirmCountdown_500ms = 3;
+}
+
+// PackBits style run length coding: a control byte 0x00..0x7F is followed by
+// 1..128 literal bytes, 0x80..0xFF by one byte that repeats 3..130 times.
+// Size is at most 128, so the output is never longer than Size + 1.
+static uint8_t RLE_Encode(const uint8_t *pIn, uint8_t Size, uint8_t *pOut)
+{
+	uint8_t i       = 0;
+	uint8_t Length  = 0;
+	uint8_t Literal = 0;    // start of the pending literal bytes
+
+	while (i < Size) {
+		uint8_t Run = 1;
+
+		while (i + Run < Size && Run < 130 && pIn[i + Run] == pIn[i])
+			Run++;
+
+		if (Run < 3 && i + Run < Size) {
+			i += Run;
+			continue;
+		}
+
+		if (Run < 3)
+			i += Run;    // the tail goes out as literals
+
+		if (i > Literal) {
+			pOut[Length++] = i - Literal - 1;
+			memcpy(pOut + Length, pIn + Literal, i - Literal);
+			Length += i - Literal;
+		}
+
+		if (Run >= 3) {
+			pOut[Length++] = 0x80 + Run - 3;
+			pOut[Length++] = pIn[i];
+			i += Run;
+		}
+
+		Literal = i;
+	}
+
+	return Length;
+}
+
+// Decodes straight into the EEPROM, one page worth of bytes at a time, or
+// with bWrite false only checks pData. Returns false unless pData is exactly
+// Length bytes that decode to exactly Size bytes.
+static bool RLE_Write(uint16_t Address, uint16_t Size, const uint8_t *pData, uint16_t Length, bool bAllowPassword, bool bWrite)
+{
+	uint8_t  Page[EEPROM_PAGE_SIZE];
+	uint8_t  Fill = 0;
+	uint16_t i    = 0;
+
+	while (Size > 0) {
+		uint8_t Control;
+		uint8_t Count;
+
+		if (i >= Length)
 			return false;
 
-#if defined(ENABLE_MESSENGER) && defined(ENABLE_MESSENGER_UART)
-    if (strncmp(((char*)UART_DMA_Buffer) + gUART_WriteIndex, "SMS:",4) == 0)
-    {
+		Control = pData[i++];
+		Count   = (Control < 0x80) ? Control + 1 : Control - 0x80 + 3;
 
-      char txMessage[PAYLOAD_LENGTH + 4];
-      memset(txMessage, 0, sizeof(txMessage));
-      snprintf(txMessage, (PAYLOAD_LENGTH + 4), "%s", &UART_DMA_Buffer[gUART_WriteIndex + 4]);
+		if (Count > Size || i + ((Control < 0x80) ? Count : 1) > Length)
+			return false;
 
-			for (int i = 0; txMessage[i] != '\0'; i++)
-			{
-				if (txMessage[i] == '\r' || txMessage[i] == '\n')
-					txMessage[i] = '\0';
+		if (!bWrite) {
+			i    += (Control < 0x80) ? Count : 1;
+			Size -= Count;
+			continue;
+		}
+
+		for (; Count > 0; Count--, Size--) {
+			Page[Fill++] = pData[i];
+			if (Control < 0x80)
+				i++;
+
+			if ((Address + Fill) % EEPROM_PAGE_SIZE == 0 || Size == 1) {
+				WriteEeprom(Address, Page, Fill, bAllowPassword);
+				Address += Fill;
+				Fill     = 0;
 			}
-      if (strlen(txMessage) > 0)
-      {
-        MSG_Send(txMessage);
-        UART_printf("SMS>%s\r\n", txMessage);
-        gUpdateDisplay = true;
-      }
-    }
+		}
 
-#endif
-		while (gUART_WriteIndex != DmaLength && UART_DMA_Buffer[gUART_WriteIndex] != 0xABU)
-			gUART_WriteIndex = DMA_INDEX(gUART_WriteIndex, 1);
+		if (Control >= 0x80)
+			i++;
+	}
 
-		if (gUART_WriteIndex == DmaLength)
-			return false;
+	return i == Length;
+}
 
-		if (gUART_WriteIndex < DmaLength)
-			CommandLength = DmaLength - gUART_WriteIndex;
-		else
-			CommandLength = (DmaLength + sizeof(UART_DMA_Buffer)) - gUART_WriteIndex;
+// Starts streaming Length bytes from Offset, as 0x0534 frames or 0x0536
+// RLE frames. Frames carry a CRC. A request that is empty or runs past the
+// end of the 8 kB EEPROM is ignored.
+static void CMD_0533(const uint8_t *pBuffer)
+{
+	const CMD_0533_t *pCmd = (const CMD_0533_t *)pBuffer;
 
-		if (CommandLength < 8)
-			return 0;
+	if (pCmd->Timestamp != Timestamp || (bHasCustomAesKey && gIsLocked))
+		return;
 
-		if (UART_DMA_Buffer[DMA_INDEX(gUART_WriteIndex, 1)] == 0xCD)
-			break;
+	if (pCmd->Length == 0 || (uint32_t)pCmd->Offset + pCmd->Length > 0x2000U)
+		return;
 
-		gUART_WriteIndex = DMA_INDEX(gUART_WriteIndex, 1);
+	SCHEDULER_TimerArm500ms(&gSerialConfigTimer, 12); // 6 sec
+
+	gStream.Sent           = pCmd->Offset;
+	gStream.Acked          = pCmd->Offset;
+	gStream.End            = pCmd->Offset + pCmd->Length;
+	gStream.Frames         = 0;
+	gStream.Window         = (pCmd->Window == 0 || pCmd->Window > STREAM_WINDOW_MAX) ? STREAM_WINDOW_MAX : pCmd->Window;
+	gStream.Countdown_10ms = STREAM_TIMEOUT_10ms;
+	gStream.bRle           = pCmd->bRle;
+}
+
+// Acknowledges everything below Offset. An acknowledge that doesn't move
+// Offset means a frame got lost, sending restarts from there.
+static void CMD_0535(const uint8_t *pBuffer)
+{
+	const CMD_0535_t *pCmd = (const CMD_0535_t *)pBuffer;
+
+	if (pCmd->Timestamp != Timestamp || pCmd->Offset < gStream.Acked || pCmd->Offset > gStream.Sent)
+		return;
+
+	SCHEDULER_TimerArm500ms(&gSerialConfigTimer, 12); // 6 sec
+
+	if (pCmd->Offset == gStream.Acked) {
+		gStream.Sent   = gStream.Acked;
+		gStream.Frames = 0;
+	}
+
+	while (gStream.Frames > 0 && gStream.FrameEnd[0] <= pCmd->Offset) {
+		gStream.Frames--;
+		memmove(gStream.FrameEnd, gStream.FrameEnd + 1, gStream.Frames * sizeof(gStream.FrameEnd[0]));
 	}
 
-	Index = DMA_INDEX(gUART_WriteIndex, 2);
-	Size  = (UART_DMA_Buffer[DMA_INDEX(Index, 1)] << 8) | UART_DMA_Buffer[Index];
+	gStream.Acked          = pCmd->Offset;
+	gStream.Countdown_10ms = STREAM_TIMEOUT_10ms;
+}
 
-	if ((Size + 8u) > sizeof(UART_DMA_Buffer))
-	{
-		gUART_WriteIndex = DmaLength;
-		return false;
+// Pipelined writes, 0x0537 has the 0x051D layout, 0x0539 carries RLE data.
+// The 0x0538 acknowledge goes out before the EEPROM is written, so the host
+// can send the next frame meanwhile. It must not have more than the 256 bytes
+// of the RX DMA ring unacknowledged. A frame that can't be written whole gets
+// no acknowledge and the host sends it again.
+static void AcknowledgeWrite(uint16_t ID, uint16_t Offset)
+{
+	REPLY_051D_t Reply;
+
+	SCHEDULER_TimerArm500ms(&gSerialConfigTimer, 12); // 6 sec
+
+	Reply.Header.ID   = 0x0538;
+	Reply.Header.Size = sizeof(Reply.Data);
+	Reply.Data.Offset = Offset;
+
+	SendReplyWithCrc(&Reply, sizeof(Reply));
+
+	// commands are handled with interrupts off, the acknowledge would only
+	// leave once the write is done
+	gStreamWritePending = ID;
+}
+
+static void CMD_0537(const uint8_t *pBuffer)
+{
+	const CMD_051D_t *pCmd = (const CMD_051D_t *)pBuffer;
+
+	if (pCmd->Timestamp == Timestamp)
+		AcknowledgeWrite(pCmd->Header.ID, pCmd->Offset);
+}
+
+static void CMD_0539(const uint8_t *pBuffer)
+{
+	const CMD_0539_t *pCmd = (const CMD_0539_t *)pBuffer;
+
+	if (pCmd->Timestamp != Timestamp || pCmd->Header.Size < sizeof(*pCmd) - sizeof(Header_t))
+		return;
+
+	// WriteEeprom() only takes whole 8 byte blocks
+	if (pCmd->Size == 0 || pCmd->Size > RLE_FRAME_RAW || (pCmd->Offset % 8U) != 0 || (pCmd->Size % 8U) != 0 ||
+		(uint32_t)pCmd->Offset + pCmd->Size > 0x2000U)
+		return;
+
+	if (!RLE_Write(pCmd->Offset, pCmd->Size, pCmd->Data, pCmd->Header.Size - (sizeof(*pCmd) - sizeof(Header_t)), pCmd->bAllowPassword, false))
+		return;
+
+	AcknowledgeWrite(pCmd->Header.ID, pCmd->Offset);
+}
+
+// Reads the next frame at gStream.Sent, at most Limit bytes of EEPROM, and
+// returns how many bytes it covers
+static uint16_t SendStreamFrame(uint16_t Limit)
+{
+	uint16_t Size = gStream.End - gStream.Sent;
+
+	if (Size > Limit)
+		Size = Limit;
+
+	if (!gStream.bRle) {
+		REPLY_051B_t Reply;
+
+		if (Size > STREAM_FRAME_SIZE)
+			Size = STREAM_FRAME_SIZE;
+
+		Reply.Header.ID    = 0x0534;
+		Reply.Header.Size  = Size + 4;
+		Reply.Data.Offset  = gStream.Sent;
+		Reply.Data.Size    = Size;
+		Reply.Data.Padding = 0;
+		EEPROM_ReadBuffer(gStream.Sent, Reply.Data.Data, Size);
+
+		SendReplyWithCrc(&Reply, Size + 8);
+	} else {
+		REPLY_0536_t Reply;
+		uint8_t      Block[RLE_BLOCK_SIZE];
+		uint8_t      Length = 0;
+
+		if (Size > RLE_FRAME_RAW)
+			Size = RLE_FRAME_RAW;
+
+		// whole blocks only while the worst case still fits
+		for (uint16_t Done = 0; Done < Size; ) {
+			const uint16_t Left  = Size - Done;
+			const uint8_t  Chunk = (Left < RLE_BLOCK_SIZE) ? Left : RLE_BLOCK_SIZE;
+
+			if (Length + Chunk + 1U > sizeof(Reply.Data.Data)) {
+				Size = Done;
+				break;
+			}
+
+			EEPROM_ReadBuffer(gStream.Sent + Done, Block, Chunk);
+			Length += RLE_Encode(Block, Chunk, Reply.Data.Data + Length);
+			Done   += Chunk;
+		}
+
+		Reply.Header.ID   = 0x0536;
+		Reply.Header.Size = Length + 4;
+		Reply.Data.Offset = gStream.Sent;
+		Reply.Data.Size   = Size;
+
+		SendReplyWithCrc(&Reply, Length + 8);
 	}
 
-	if (CommandLength < (Size + 8))
-		return false;
+	return Size;
+}
+
+// Samples RSSI, noise and glitch indicators every Interval_10ms ticks (1 is
+// every tick) into 0x053C frames, Interval_10ms 0 stops it. The reply holds
+// the interval in effect, 0 when the build has no TX ring to queue into.
+static void CMD_053A(const uint8_t *pBuffer)
+{
+	const CMD_053A_t *pCmd = (const CMD_053A_t *)pBuffer;
+	REPLY_053B_t      Reply;
 
-	Index     = DMA_INDEX(Index, 2);
-	TailIndex = DMA_INDEX(Index, Size + 2);
+	if (pCmd->Timestamp != Timestamp)
+		return;
 
-	if (UART_DMA_Buffer[TailIndex] != 0xDC || UART_DMA_Buffer[DMA_INDEX(TailIndex, 1)] != 0xBA)
-	{
-		gUART_WriteIndex = DmaLength;
-		return false;
+	#ifdef ENABLE_UART_TX_IRQ
+		gTelemetry.Interval_10ms = pCmd->Interval_10ms;
+	#else
+		// every frame would hold the main loop until it is out, refused (0)
+		gTelemetry.Interval_10ms = 0;
+	#endif
+	gTelemetry.Countdown_10ms = 1;
+	gTelemetry.Count          = 0;
+	gTelemetry.Sequence       = 0;
+
+	Reply.Header.ID          = 0x053B;
+	Reply.Header.Size        = sizeof(Reply.Data);
+	Reply.Data.Interval_10ms = gTelemetry.Interval_10ms;
+
+	SendReply(&Reply, sizeof(Reply));
+}
+
+static void TelemetryTimeSlice10ms(void)
+{
+	uint16_t Size;
+
+	gTelemetry.Tick_10ms++;
+
+	if (gTelemetry.Interval_10ms == 0)
+		return;
+
+	// the BK4819 sleeps in power save, keep it listening
+	SCHEDULER_TimerArm(&gBatterySaveTimer, battery_save_count_10ms);
+	if (gCurrentFunction == FUNCTION_POWER_SAVE)
+		FUNCTION_Select(FUNCTION_FOREGROUND);
+
+	if (--gTelemetry.Countdown_10ms == 0) {
+		TelemetryRecord_t *pRecord;
+
+		gTelemetry.Countdown_10ms = gTelemetry.Interval_10ms;
+
+		if (gTelemetry.Count == TELEMETRY_RECORDS) {
+			gTelemetry.Count--;
+			memmove(gTelemetry.Reply.Records, gTelemetry.Reply.Records + 1, gTelemetry.Count * sizeof(TelemetryRecord_t));
+		}
+
+		pRecord                   = &gTelemetry.Reply.Records[gTelemetry.Count++];
+		pRecord->Sequence         = gTelemetry.Sequence++;
+		pRecord->Tick_10ms        = gTelemetry.Tick_10ms;
+		pRecord->RSSI             = BK4819_GetRSSI();
+		pRecord->ExNoiseIndicator = BK4819_GetExNoiceIndicator();
+		pRecord->GlitchIndicator  = BK4819_GetGlitchIndicator();
 	}
 
-	if (TailIndex < Index)
-	{
-		const uint16_t ChunkSize = sizeof(UART_DMA_Buffer) - Index;
-		memmove(UART_Command.Buffer, UART_DMA_Buffer + Index, ChunkSize);
-		memmove(UART_Command.Buffer + ChunkSize, UART_DMA_Buffer, TailIndex);
+	// everything waiting goes in one frame, 8 bytes around it
+	Size = sizeof(Header_t) + sizeof(gTelemetry.Reply.DutyCycle) + gTelemetry.Count * sizeof(TelemetryRecord_t);
+	if (gTelemetry.Count == 0 || UART_TxFree() < Size + 8U)
+		return;
+
+	gTelemetry.Reply.Header.ID   = 0x053C;
+	gTelemetry.Reply.Header.Size = Size - sizeof(Header_t);
+	#ifdef ENABLE_WFI_IDLE
+		gTelemetry.Reply.DutyCycle = SCHEDULER_GetDutyCycle();
+	#else
+		gTelemetry.Reply.DutyCycle = 1000;    // never sleeps
+	#endif
+	SendReplyWithCrc(&gTelemetry.Reply, Size);
+	gTelemetry.Count = 0;
+}
+
+// Runs right after the command handling with interrupts enabled
+void UART_TimeSlice10ms(void)
+{
+	if (gStreamWritePending == 0x0537) {
+		const CMD_051D_t *pCmd = (const CMD_051D_t *)UART_Command.Buffer;
+
+		WriteEeprom(pCmd->Offset, pCmd->Data, pCmd->Size, pCmd->bAllowPassword);
+	} else if (gStreamWritePending == 0x0539) {
+		const CMD_0539_t *pCmd = (const CMD_0539_t *)UART_Command.Buffer;
+
+		// CMD_0539 checked the data before acknowledging it, this can't fail
+		RLE_Write(pCmd->Offset, pCmd->Size, pCmd->Data, pCmd->Header.Size - (sizeof(*pCmd) - sizeof(Header_t)), pCmd->bAllowPassword, true);
+	}
+	gStreamWritePending = 0;
+
+	TelemetryTimeSlice10ms();
+
+	if (gStream.Acked == gStream.End)
+		return;
+
+	if (--gStream.Countdown_10ms == 0) {
+		gStream.Sent           = gStream.Acked;
+		gStream.Frames         = 0;
+		gStream.Countdown_10ms = STREAM_TIMEOUT_10ms;
+	}
+
+	for (uint16_t Budget = STREAM_BYTES_PER_TICK; Budget > 0 && gStream.Sent != gStream.End; ) {
+		uint16_t Size;
+
+		// a frame is never longer than 128 bytes of data plus 16 around it
+		if (gStream.Frames >= gStream.Window || UART_TxFree() < STREAM_FRAME_SIZE + 16U)
+			break;
+
+		Size          = SendStreamFrame(Budget);
+		Budget       -= Size;
+		gStream.Sent += Size;
+		gStream.FrameEnd[gStream.Frames++] = gStream.Sent;
+	}
+}
+
+#ifdef ENABLE_SPECTRUM_UART
+// Sends a finished spectrum sweep as a 0x053D frame. The first bin goes as
+// is, the rest as the difference to the bin before (-127..127), or 0x80 and
+// the value. The sweep mustn't wait on the link, so when the frame doesn't
+// fit in the TX ring it is dropped and the sequence skips one.
+void UART_SendSpectrum(uint32_t Frequency, uint32_t Step, const uint16_t *pRssi, uint8_t Bins)
+{
+	REPLY_053D_t Reply;
+	uint16_t     Size = 0;
+	uint16_t     Last;
+	unsigned int i;
+
+	Reply.Data.Sequence = gSpectrumSequence++;
+
+	if (Bins == 0 || UART_TxFree() < sizeof(Reply) - sizeof(Reply.Data.Rssi) + Bins + 8U)
+		return;
+
+	Last = pRssi[0];
+	Reply.Data.Rssi[Size++] = (Last >> 0) & 0xFF;
+	Reply.Data.Rssi[Size++] = (Last >> 8) & 0xFF;
+
+	for (i = 1; i < Bins; i++) {
+		const int32_t Delta = (int32_t)pRssi[i] - Last;
+
+		if (Size + 3U > sizeof(Reply.Data.Rssi))
+			return;
+
+		if (Delta >= -127 && Delta <= 127)
+			Reply.Data.Rssi[Size++] = (uint8_t)Delta;
+		else {
+			Reply.Data.Rssi[Size++] = 0x80;
+			Reply.Data.Rssi[Size++] = (pRssi[i] >> 0) & 0xFF;
+			Reply.Data.Rssi[Size++] = (pRssi[i] >> 8) & 0xFF;
+		}
+		Last = pRssi[i];
+	}
+
+	Size += sizeof(Reply) - sizeof(Reply.Data.Rssi);
+	if (UART_TxFree() < Size + 8U)
+		return;
+
+	Reply.Header.ID       = 0x053D;
+	Reply.Header.Size     = Size - sizeof(Header_t);
+	Reply.Data.Frequency  = Frequency;
+	Reply.Data.Step       = Step;
+	Reply.Data.Bins       = Bins;
+	Reply.Data.Padding    = 0;
+
+	SendReplyWithCrc(&Reply, Size);
+}
+#endif
+
+void UART_TimeSlice500ms(void)
+{
+	if (gUART_BaudRate == UART_BAUD_RATE_DEFAULT)
+		return;
+
+	if (gUART_BaudConfirmCountdown_500ms > 0) {
+		if (--gUART_BaudConfirmCountdown_500ms > 0)
+			return;
 	}
-	else
-		memmove(UART_Command.Buffer, UART_DMA_Buffer + Index, TailIndex - Index);
+	else if (SCHEDULER_TimerPending(&gSerialConfigTimer) || gTelemetry.Interval_10ms > 0)
+		return;
+
+	gUART_BaudRate = UART_BAUD_RATE_DEFAULT;
+	UART_SetBaudRate(gUART_BaudRate);
+}
+
+// Catches the CRC up with the payload received so far. Byte 0 isn't final
+// until byte 1 tells whether the frame is obfuscated.
+static void UpdateCrc(void)
+{
+	const uint16_t End = MIN(gParser.Index, gParser.Size);
 
-	TailIndex = DMA_INDEX(TailIndex, 2);
-	if (TailIndex < gUART_WriteIndex)
+	if (End < 2 || End == gParser.CrcIndex)
+		return;
+
+	gParser.Crc      = CRC_Update(gParser.Crc, UART_Command.Buffer + gParser.CrcIndex, End - gParser.CrcIndex);
+	gParser.CrcIndex = End;
+}
+
+// Not a frame after all, look for one from the byte after the 0xAB unless
+// the DMA has gone round and written over it since
+static void Resync(void)
+{
+	const uint16_t DmaLength = DMA_CH0->ST & 0xFFFU;
+	const uint16_t Parsed    = DMA_INDEX(gUART_WriteIndex, sizeof(UART_DMA_Buffer) - gParser.Start);
+	const uint16_t Unread    = DMA_INDEX(DmaLength, sizeof(UART_DMA_Buffer) - gUART_WriteIndex);
+
+	if (Parsed + Unread < sizeof(UART_DMA_Buffer))
+		gUART_WriteIndex = DMA_INDEX(gParser.Start, 1);
+
+	gParser.State = PARSER_SYNC0;
+}
+
+static bool ParseByte(uint8_t Byte, uint16_t DmaIndex)
+{
+	switch (gParser.State)
 	{
-		memset(UART_DMA_Buffer + gUART_WriteIndex, 0, sizeof(UART_DMA_Buffer) - gUART_WriteIndex);
-		memset(UART_DMA_Buffer, 0, TailIndex);
+		case PARSER_SYNC0:
+			break;
+
+		case PARSER_SYNC1:
+			if (Byte != 0xCD)
+				break;
+			gParser.State = PARSER_SIZE0;
+			return false;
+
+		case PARSER_SIZE0:
+			gParser.Size  = Byte;
+			gParser.State = PARSER_SIZE1;
+			return false;
+
+		case PARSER_SIZE1:
+			gParser.Size |= Byte << 8;
+			if (gParser.Size < sizeof(Header_t) || (gParser.Size + 8U) > sizeof(UART_DMA_Buffer)) {
+				Resync();
+				return false;
+			}
+			gParser.Index      = 0;
+			gParser.CrcIndex   = 0;
+			gParser.Crc        = 0;
+			gParser.bEncrypted = bIsEncrypted;
+			gParser.State      = PARSER_PAYLOAD;
+			return false;
+
+		case PARSER_PAYLOAD:
+			// the raw ID switches the obfuscation on or off
+			if (gParser.Index == 1) {
+				const uint16_t ID = UART_Command.Buffer[0] | (Byte << 8);
+
+				if (ID == 0x0514)
+					gParser.bEncrypted = false;
+				if (ID == 0x6902)
+					gParser.bEncrypted = true;
+				if (gParser.bEncrypted)
+					UART_Command.Buffer[0] ^= Obfuscation[0];
+			}
+			if (gParser.bEncrypted && gParser.Index > 0)
+				Byte ^= Obfuscation[gParser.Index % 16];
+
+			UART_Command.Buffer[gParser.Index++] = Byte;
+
+			if (gParser.Index == gParser.Size)
+				UpdateCrc();
+			else if (gParser.Index == gParser.Size + 2U)
+				gParser.State = PARSER_FOOTER0;
+			return false;
+
+		case PARSER_FOOTER0:
+			if (Byte == 0xDC)
+				gParser.State = PARSER_FOOTER1;
+			else
+				Resync();
+			return false;
+
+		case PARSER_FOOTER1:
+			if (Byte != 0xBA) {
+				Resync();
+				return false;
+			}
+			gParser.State = PARSER_SYNC0;
+			bIsEncrypted  = gParser.bEncrypted;
+			return gParser.Crc == (UART_Command.Buffer[gParser.Size] | (UART_Command.Buffer[gParser.Size + 1] << 8));
+
+#if defined(ENABLE_MESSENGER) && defined(ENABLE_MESSENGER_UART)
+		case PARSER_SMS_M:
+			if (Byte != 'M')
+				break;
+			gParser.State = PARSER_SMS_S;
+			return false;
+
+		case PARSER_SMS_S:
+			if (Byte != 'S')
+				break;
+			gParser.State = PARSER_SMS_COLON;
+			return false;
+
+		case PARSER_SMS_COLON:
+			if (Byte != ':')
+				break;
+			gParser.Index = 0;
+			gParser.State = PARSER_SMS_TEXT;
+			return false;
+
+		case PARSER_SMS_TEXT:
+			if (Byte != '\r' && Byte != '\n') {
+				if (gParser.Index < PAYLOAD_LENGTH + 3)
+					UART_Command.Buffer[gParser.Index++] = Byte;
+				return false;
+			}
+			gParser.State = PARSER_SYNC0;
+			if (gParser.Index > 0) {
+				UART_Command.Buffer[gParser.Index] = 0;
+				MSG_Send((const char *)UART_Command.Buffer);
+				UART_printf("SMS>%s\r\n", UART_Command.Buffer);
+				gUpdateDisplay = true;
+			}
+			return false;
+#endif
 	}
-	else
-		memset(UART_DMA_Buffer + gUART_WriteIndex, 0, TailIndex - gUART_WriteIndex);
 
-	gUART_WriteIndex = TailIndex;
+	// anything unexpected may be the start of the next frame
+	gParser.State = PARSER_SYNC0;
 
-	if (UART_Command.Header.ID == 0x0514)
-		bIsEncrypted = false;
+	if (Byte == 0xAB) {
+		gParser.Start = DmaIndex;
+		gParser.State = PARSER_SYNC1;
+	}
+#if defined(ENABLE_MESSENGER) && defined(ENABLE_MESSENGER_UART)
+	else if (Byte == 'S')
+		gParser.State = PARSER_SMS_M;
+#endif
 
-	if (UART_Command.Header.ID == 0x6902)
-		bIsEncrypted = true;
+	return false;
+}
 
-	if (bIsEncrypted)
+bool UART_IsCommandAvailable(void)
+{
+	const uint16_t DmaLength = DMA_CH0->ST & 0xFFFU;
+
+	while (gUART_WriteIndex != DmaLength)
 	{
-		unsigned int i;
-		for (i = 0; i < (Size + 2u); i++)
-			UART_Command.Buffer[i] ^= Obfuscation[i % 16];
+		const uint16_t Index = gUART_WriteIndex;
+
+		gUART_WriteIndex = DMA_INDEX(gUART_WriteIndex, 1);
+
+		// the rest stays in the ring until the command has been handled
+		if (ParseByte(UART_DMA_Buffer[Index], Index))
+			return true;
 	}
 
-	CRC = UART_Command.Buffer[Size] | (UART_Command.Buffer[Size + 1] << 8);
+	if (gParser.State == PARSER_PAYLOAD)
+		UpdateCrc();
 
-	return (CRC_Calculate(UART_Command.Buffer, Size) != CRC) ? false : true;
+	return false;
 }
 
 void UART_HandleCommand(void)
 {
+	// a valid command made it through at the new rate
+	gUART_BaudConfirmCountdown_500ms = 0;
+
 	switch (UART_Command.Header.ID)
 	{
 		case 0x0514:
@@ -512,7 +1228,33 @@ void UART_HandleCommand(void)
 			CMD_052F(UART_Command.Buffer);
 			break;
 
+		case 0x0531:
+			CMD_0531(UART_Command.Buffer);
+			break;
+
+		case 0x0533:
+			CMD_0533(UART_Command.Buffer);
+			break;
+
+		case 0x0535:
+			CMD_0535(UART_Command.Buffer);
+			break;
+
+		case 0x0537:
+			CMD_0537(UART_Command.Buffer);
+			break;
+
+		case 0x0539:
+			CMD_0539(UART_Command.Buffer);
+			break;
+
+		case 0x053A:
+			CMD_053A(UART_Command.Buffer);
+			break;
+
 		case 0x05DD:
+			EEPROM_Flush();
+			UART_Flush();
 			#if defined(ENABLE_OVERLAY)
 				overlay_FLASH_RebootToBootloader();
 			#else
@@ -21,9 +21,15 @@
 #define APP_UART_H
 
 #include <stdbool.h>
+#include <stdint.h>
 
 bool UART_IsCommandAvailable(void);
 void UART_HandleCommand(void);
+void UART_TimeSlice10ms(void);
+void UART_TimeSlice500ms(void);
+#ifdef ENABLE_SPECTRUM_UART
+	void UART_SendSpectrum(uint32_t Frequency, uint32_t Step, const uint16_t *pRssi, uint8_t Bins);
+#endif
 
 #endif
 
@@ -65,7 +65,7 @@
 	VOICE_ID_t        gVoiceID[8];
 	uint8_t           gVoiceReadIndex;
 	uint8_t           gVoiceWriteIndex;
-	volatile uint16_t gCountdownToPlayNextVoice_10ms;
+	SCHEDULER_Timer_t gVoiceTimer;
 	volatile bool     gFlagPlayQueuedVoice;
 	VOICE_ID_t        gAnotherVoiceID = VOICE_ID_INVALID;
 	
@@ -313,7 +313,7 @@ void AUDIO_PlayBeep(BEEP_Type_t Beep)
 			}
 	
 			gVoiceReadIndex                = 1;
-			gCountdownToPlayNextVoice_10ms = Delay;
+			SCHEDULER_TimerArm(&gVoiceTimer, Delay);
 			gFlagPlayQueuedVoice           = false;
 	
 			return;
@@ -419,7 +419,7 @@ void AUDIO_PlayBeep(BEEP_Type_t Beep)
 	
 				AUDIO_PlayVoice(VoiceID);
 				
-				gCountdownToPlayNextVoice_10ms = Delay;
+				SCHEDULER_TimerArm(&gVoiceTimer, Delay);
 				gFlagPlayQueuedVoice           = false;
 
 				#ifdef ENABLE_VOX
@@ -25,6 +25,7 @@
 
 #include "bsp/dp32g030/gpio.h"
 #include "driver/gpio.h"
+#include "scheduler.h"
 
 enum BEEP_Type_t
 {
@@ -148,7 +149,7 @@ static inline void AUDIO_AudioPathOff(void) {
 	extern VOICE_ID_t        gVoiceID[8];
 	extern uint8_t           gVoiceReadIndex;
 	extern uint8_t           gVoiceWriteIndex;
-	extern volatile uint16_t gCountdownToPlayNextVoice_10ms;
+	extern SCHEDULER_Timer_t gVoiceTimer;
 	extern volatile bool     gFlagPlayQueuedVoice;
 	extern VOICE_ID_t        gAnotherVoiceID;
 	
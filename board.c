@@ -40,6 +40,7 @@
 #include "driver/gpio.h"
 #include "driver/system.h"
 #include "driver/st7565.h"
+#include "driver/uart.h"
 #include "frequencies.h"
 #include "helper/battery.h"
 #include "misc.h"
@@ -515,9 +516,15 @@ void BOARD_EEPROM_Init(void)
 {
 	unsigned int i;
 	uint8_t      Data[16];
+	uint8_t      Image[0x0F48 - 0x0E70];
 
 	memset(Data, 0, sizeof(Data));
 
+	EEPROM_JournalInit();
+
+	// 0E70..0F47 in one go, the reads below are served from RAM
+	EEPROM_MapImage(0x0E70, Image, sizeof(Image));
+
 	// 0E70..0E77
 	EEPROM_ReadBuffer(0x0E70, Data, 8);
 	gEeprom.CHAN_1_CALL          = IS_MR_CHANNEL(Data[0]) ? Data[0] : MR_CHANNEL_FIRST;
@@ -723,6 +730,13 @@ void BOARD_EEPROM_Init(void)
 		gEeprom.ScreenChannel[1] = gEeprom.MrChannel[1];
 	}
 
+	#ifdef ENABLE_ENCRYPTION
+		// 0F30..0F3F - load encryption key
+		EEPROM_ReadBuffer(0x0F30, gEeprom.ENC_KEY, sizeof(gEeprom.ENC_KEY));
+	#endif
+
+	EEPROM_UnmapImage();
+
 	// 0D60..0E27
 	EEPROM_ReadBuffer(0x0D60, gMR_ChannelAttributes, sizeof(gMR_ChannelAttributes));
 	for(uint16_t i = 0; i < sizeof(gMR_ChannelAttributes); i++) {
@@ -732,35 +746,114 @@ void BOARD_EEPROM_Init(void)
 			att->band = 0xf;
 		}
 	}
-	#ifdef ENABLE_ENCRYPTION
-		// 0F30..0F3F - load encryption key
-		EEPROM_ReadBuffer(0x0F30, gEeprom.ENC_KEY, sizeof(gEeprom.ENC_KEY));
-	#endif
+}
+#ifdef ENABLE_SPECTRUM_SHOW_CHANNEL_NAME
+// Entries of gMR_ChannelFrequencyAttributes are read from the EEPROM on first
+// use and dropped again when the channel is saved
+static uint8_t gMR_FrequencyLoaded[(MR_CHANNEL_LAST + 8) / 8];
+static uint8_t gMR_NameLoaded[(MR_CHANNEL_LAST + 8) / 8];
+
+// Channels with a loaded, valid frequency sorted by frequency, then channel
+static uint8_t gMR_FrequencyIndex[MR_CHANNEL_LAST + 1];
+static uint8_t gMR_FrequencyIndexCount;
+static bool    gMR_FrequencyIndexStale = true;  // some frequencies not loaded
+
+// First index position not below (freq, channel)
+static uint8_t BOARD_gMR_IndexSearch(const uint32_t freq, const uint8_t channel)
+{
+	uint8_t lo = 0;
+	uint8_t hi = gMR_FrequencyIndexCount;
 
-	#ifdef ENABLE_SPECTRUM_SHOW_CHANNEL_NAME
-		BOARD_gMR_LoadChannels();
-	#endif
+	while (lo < hi)
+	{
+		const uint8_t  mid = (lo + hi) / 2;
+		const uint8_t  ch  = gMR_FrequencyIndex[mid];
+		const uint32_t f   = gMR_ChannelFrequencyAttributes[ch].Frequency;
+
+		if (f < freq || (f == freq && ch < channel))
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
 
+	return lo;
+}
+
+static void BOARD_gMR_IndexInsert(const uint8_t channel)
+{
+	const uint8_t pos = BOARD_gMR_IndexSearch(gMR_ChannelFrequencyAttributes[channel].Frequency, channel);
+
+	memmove(&gMR_FrequencyIndex[pos + 1], &gMR_FrequencyIndex[pos], gMR_FrequencyIndexCount - pos);
+	gMR_FrequencyIndex[pos] = channel;
+	gMR_FrequencyIndexCount++;
+}
+
+static void BOARD_gMR_IndexRemove(const uint8_t channel)
+{
+	const uint8_t pos = BOARD_gMR_IndexSearch(gMR_ChannelFrequencyAttributes[channel].Frequency, channel);
+
+	if (pos < gMR_FrequencyIndexCount && gMR_FrequencyIndex[pos] == channel)
+	{
+		gMR_FrequencyIndexCount--;
+		memmove(&gMR_FrequencyIndex[pos], &gMR_FrequencyIndex[pos + 1], gMR_FrequencyIndexCount - pos);
+	}
 }
-#ifdef ENABLE_SPECTRUM_SHOW_CHANNEL_NAME
-// Load channel frequencies, names into global memory lookup table
-void BOARD_gMR_LoadChannels() {
-	uint8_t  i;
-	uint32_t freq_buf;
 
-	for (i = MR_CHANNEL_FIRST; i <= MR_CHANNEL_LAST; i++)
+uint32_t BOARD_gMR_ChannelFrequency(const uint8_t channel)
+{
+	ChannelFrequencyAttributes *pEntry = &gMR_ChannelFrequencyAttributes[channel];
+
+	if (!(gMR_FrequencyLoaded[channel / 8] & (1u << (channel % 8))))
 	{
-		freq_buf = BOARD_fetchChannelFrequency(i);
+		const uint32_t freq_buf = BOARD_fetchChannelFrequency(channel);
+
+		pEntry->Frequency = RX_freq_check(freq_buf) == -1 ? 0 : freq_buf;
+		gMR_FrequencyLoaded[channel / 8] |= 1u << (channel % 8);
 
-		gMR_ChannelFrequencyAttributes[i].Frequency = RX_freq_check(freq_buf) == -1 ? 0 : freq_buf;
-		SETTINGS_FetchChannelName(gMR_ChannelFrequencyAttributes[i].Name, i);
+		if (pEntry->Frequency != 0)
+			BOARD_gMR_IndexInsert(channel);
 	}
+
+	return pEntry->Frequency;
+}
+
+const char *BOARD_gMR_ChannelName(const uint8_t channel)
+{
+	ChannelFrequencyAttributes *pEntry = &gMR_ChannelFrequencyAttributes[channel];
+
+	if (!(gMR_NameLoaded[channel / 8] & (1u << (channel % 8))))
+	{
+		SETTINGS_FetchChannelName(pEntry->Name, channel);
+		gMR_NameLoaded[channel / 8] |= 1u << (channel % 8);
+	}
+
+	return pEntry->Name;
+}
+
+void BOARD_gMR_InvalidateChannel(const uint8_t channel)
+{
+	if (!IS_MR_CHANNEL(channel))
+		return;
+
+	if (gMR_FrequencyLoaded[channel / 8] & (1u << (channel % 8)))
+	{
+		if (gMR_ChannelFrequencyAttributes[channel].Frequency != 0)
+			BOARD_gMR_IndexRemove(channel);
+		gMR_FrequencyIndexStale = true;
+	}
+
+	gMR_FrequencyLoaded[channel / 8] &= ~(1u << (channel % 8));
+	gMR_NameLoaded[channel / 8]      &= ~(1u << (channel % 8));
 }
 #endif
 
 void BOARD_EEPROM_LoadCalibration(void)
 {
 //	uint8_t Mic;
+	uint8_t Image[0x1F90 - 0x1EC0];
+
+	// 1EC0..1F8F in one go
+	EEPROM_MapImage(0x1EC0, Image, sizeof(Image));
 
 	EEPROM_ReadBuffer(0x1EC0, gEEPROM_RSSI_CALIB[3], 8);
 	memcpy(gEEPROM_RSSI_CALIB[4], gEEPROM_RSSI_CALIB[3], 8);
@@ -812,36 +905,69 @@ void BOARD_EEPROM_LoadCalibration(void)
 		BK4819_WriteRegister(BK4819_REG_3B, 22656 + gEeprom.BK4819_XTAL_FREQ_LOW);
 //		BK4819_WriteRegister(BK4819_REG_3C, gEeprom.BK4819_XTAL_FREQ_HIGH);
 	}
+
+	EEPROM_UnmapImage();
 }
 
 uint32_t BOARD_fetchChannelFrequency(const int channel)
 {
-	struct
-	{
-		uint32_t frequency;
-		uint32_t offset;
-	} __attribute__((packed)) info;
+	uint32_t frequency;
 
-	EEPROM_ReadBuffer(channel * 16, &info, sizeof(info));
+	EEPROM_ReadBuffer(channel * 16, &frequency, sizeof(frequency));
 
-	return info.frequency;
+	return frequency;
 }
 #ifdef ENABLE_SPECTRUM_SHOW_CHANNEL_NAME
-	int BOARD_gMR_fetchChannel(const uint32_t freq)
+// Channel closest to freq, at most tolerance away. The lowest channel number
+// wins among channels on the same frequency. Returns -1 if there is none.
+int BOARD_gMR_fetchChannel(const uint32_t freq, const uint32_t tolerance)
+{
+	uint8_t  pos;
+	int      channel = -1;
+	uint32_t delta   = tolerance;
+
+	if (gMR_FrequencyIndexStale)
 	{
-		for (int i = MR_CHANNEL_FIRST; i <= MR_CHANNEL_LAST; i++) {
-			if (gMR_ChannelFrequencyAttributes[i].Frequency == freq)
-				return i;
+		for (uint8_t i = MR_CHANNEL_FIRST; i <= MR_CHANNEL_LAST; i++)
+			BOARD_gMR_ChannelFrequency(i);
+		gMR_FrequencyIndexStale = false;
+	}
+
+	pos = BOARD_gMR_IndexSearch(freq, MR_CHANNEL_FIRST);
+
+	if (pos < gMR_FrequencyIndexCount)
+	{
+		const uint8_t ch = gMR_FrequencyIndex[pos];
+
+		if (gMR_ChannelFrequencyAttributes[ch].Frequency - freq <= delta)
+		{
+			channel = ch;
+			delta   = gMR_ChannelFrequencyAttributes[ch].Frequency - freq;
 		}
-		// Return -1 if no channel found
-		return -1;
 	}
+
+	if (pos > 0)
+	{
+		const uint32_t f = gMR_ChannelFrequencyAttributes[gMR_FrequencyIndex[pos - 1]].Frequency;
+
+		if (freq - f < delta || (channel < 0 && freq - f <= delta))
+		{
+			// first of the channels sharing that frequency
+			pos = BOARD_gMR_IndexSearch(f, MR_CHANNEL_FIRST);
+			channel = gMR_FrequencyIndex[pos];
+		}
+	}
+
+	return channel;
+}
 #endif
 
 void BOARD_FactoryReset(bool bIsAll)
 {
 	uint16_t i;
-	uint8_t  Template[8];
+	uint16_t Start  = 0;
+	uint8_t  Length = 0;
+	uint8_t  Template[EEPROM_PAGE_SIZE];
 
 	memset(Template, 0xFF, sizeof(Template));
 
@@ -863,7 +989,21 @@ void BOARD_FactoryReset(bool bIsAll)
 				))
 			)
 		{
-			EEPROM_WriteBuffer(i, Template, true);
+			if (Length == 0)
+				Start = i;
+			Length += 8;
+		}
+		else if (Length > 0)
+		{
+			EEPROM_WriteBlock(Start, Template, Length, true);
+			Length = 0;
+		}
+
+		// erase a page at a time
+		if (Length > 0 && ((i + 8) % EEPROM_PAGE_SIZE) == 0)
+		{
+			EEPROM_WriteBlock(Start, Template, Length, true);
+			Length = 0;
 		}
 	}
 
@@ -886,6 +1026,8 @@ void BOARD_FactoryReset(bool bIsAll)
 			SETTINGS_SaveChannel(MR_CHANNEL_FIRST + i, 0, gRxVfo, 2);
 		}
 		// reboot device
+		EEPROM_Flush();
+		UART_Flush();
 		NVIC_SystemReset();
 	}
 }
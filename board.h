@@ -34,8 +34,10 @@ void     BOARD_EEPROM_LoadCalibration(void);
 uint32_t BOARD_fetchChannelFrequency(const int channel);
 void     BOARD_FactoryReset(bool bIsAll);
 #ifdef ENABLE_SPECTRUM_SHOW_CHANNEL_NAME
-void     BOARD_gMR_LoadChannels();
-int      BOARD_gMR_fetchChannel(const uint32_t freq);
+uint32_t    BOARD_gMR_ChannelFrequency(const uint8_t channel);
+const char *BOARD_gMR_ChannelName(const uint8_t channel);
+void        BOARD_gMR_InvalidateChannel(const uint8_t channel);
+int         BOARD_gMR_fetchChannel(const uint32_t freq, const uint32_t tolerance);
 #endif
 
 #endif
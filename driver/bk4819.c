@@ -39,6 +39,14 @@ static const uint8_t DTMF_TONE2_GAIN = 93;
 
 static uint16_t gBK4819_GpioOutState;
 
+// RAM copy of the configuration registers. Those only change when we write
+// them, so read-modify-write sequences can skip the bus read entirely.
+static uint16_t gBK4819_Shadow[0x80];
+static uint32_t gBK4819_ShadowValid[0x80 / 32];
+
+uint32_t gBK4819_ShadowHits;
+uint32_t gBK4819_ShadowMisses;
+
 bool gRxIdleMode;
 
 __inline uint16_t scale_freq(const uint16_t freq)
@@ -47,23 +55,63 @@ __inline uint16_t scale_freq(const uint16_t freq)
 	return (((uint32_t)freq * 1353245u) + (1u << 16)) >> 17;   // with rounding
 }
 
-void BK4819_Init(void)
+static const BK4819_RegWrite_t BK4819_RxOn[] =
 {
-	GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCN);
-	GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCL);
-	GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SDA);
+	// DSP Voltage Setting = 1
+	// ANA LDO = 2.7v
+	// VCO LDO = 2.7v
+	// RF LDO  = 2.7v
+	// PLL LDO = 2.7v
+	// ANA LDO bypass
+	// VCO LDO bypass
+	// RF LDO  bypass
+	// PLL LDO bypass
+	// Reserved bit is 1 instead of 0
+	// Enable  DSP
+	// Enable  XTAL
+	// Enable  Band Gap
+	//
+	{BK4819_REG_37, 0x1F0F},  // 0001111100001111
 
-	BK4819_WriteRegister(BK4819_REG_00, 0x8000);
-	BK4819_WriteRegister(BK4819_REG_00, 0x0000);
+	// Turn off everything
+	{BK4819_REG_30, 0},
 
-	BK4819_WriteRegister(BK4819_REG_37, 0x1D0F);
-	BK4819_WriteRegister(BK4819_REG_36, 0x0022);
+	{BK4819_REG_30,
+		BK4819_REG_30_ENABLE_VCO_CALIB |
+		BK4819_REG_30_DISABLE_UNKNOWN |
+		BK4819_REG_30_ENABLE_RX_LINK |
+		BK4819_REG_30_ENABLE_AF_DAC |
+		BK4819_REG_30_ENABLE_DISC_MODE |
+		BK4819_REG_30_ENABLE_PLL_VCO |
+		BK4819_REG_30_DISABLE_PA_GAIN |
+		BK4819_REG_30_DISABLE_MIC_ADC |
+		BK4819_REG_30_DISABLE_TX_DSP |
+		BK4819_REG_30_ENABLE_RX_DSP},
+};
 
-	BK4819_SetDefaultAmplifierSettings();
+static uint16_t BK4819_AFValue(BK4819_AF_Type_t AF)
+{
+	// AF Output Inverse Mode = Inverse
+	// Undocumented bits 0x2040
+	//
+//	return 0x6040 | (AF << 8);
+	return (6u << 12) | (AF << 8) | (1u << 6);
+}
+
+static const BK4819_RegWrite_t BK4819_InitReset[] =
+{
+	{BK4819_REG_00, 0x8000},
+	{BK4819_REG_00, 0x0000},
 
-	BK4819_WriteRegister(BK4819_REG_19, 0b0001000001000001);   // <15> MIC AGC  1 = disable  0 = enable
+	{BK4819_REG_37, 0x1D0F},
+	{BK4819_REG_36, 0x0022},
+};
+
+static const BK4819_RegWrite_t BK4819_InitDefaults[] =
+{
+	{BK4819_REG_19, 0b0001000001000001},   // <15> MIC AGC  1 = disable  0 = enable
 
-	BK4819_WriteRegister(BK4819_REG_7D, 0xE940);
+	{BK4819_REG_7D, 0xE940},
 
 	// REG_48 .. RX AF level
 	//
@@ -83,43 +131,50 @@ void BK4819_Init(void)
 	//         15 = max
 	//          0 = min
 	//
-	BK4819_WriteRegister(BK4819_REG_48,	//  0xB3A8);     // 1011 00 111010 1000
+	{BK4819_REG_48,	//  0xB3A8);     // 1011 00 111010 1000
 		(11u << 12) |     // ??? 0..15
 		( 0u << 10) |     // AF Rx Gain-1
 		(58u <<  4) |     // AF Rx Gain-2
-		( 8u <<  0));     // AF DAC Gain (after Gain-1 and Gain-2)
-
-#if 1
-	const uint8_t dtmf_coeffs[] = {111, 107, 103, 98, 80, 71, 58, 44, 65, 55, 37, 23, 228, 203, 181, 159};
-	for (unsigned int i = 0; i < ARRAY_SIZE(dtmf_coeffs); i++)
-		BK4819_WriteRegister(BK4819_REG_09, (i << 12) | dtmf_coeffs[i]);
-#else
-	// original code
-	BK4819_WriteRegister(BK4819_REG_09, 0x006F);  // 6F
-	BK4819_WriteRegister(BK4819_REG_09, 0x106B);  // 6B
-	BK4819_WriteRegister(BK4819_REG_09, 0x2067);  // 67
-	BK4819_WriteRegister(BK4819_REG_09, 0x3062);  // 62
-	BK4819_WriteRegister(BK4819_REG_09, 0x4050);  // 50
-	BK4819_WriteRegister(BK4819_REG_09, 0x5047);  // 47
-	BK4819_WriteRegister(BK4819_REG_09, 0x603A);  // 3A
-	BK4819_WriteRegister(BK4819_REG_09, 0x702C);  // 2C
-	BK4819_WriteRegister(BK4819_REG_09, 0x8041);  // 41
-	BK4819_WriteRegister(BK4819_REG_09, 0x9037);  // 37
-	BK4819_WriteRegister(BK4819_REG_09, 0xA025);  // 25
-	BK4819_WriteRegister(BK4819_REG_09, 0xB017);  // 17
-	BK4819_WriteRegister(BK4819_REG_09, 0xC0E4);  // E4
-	BK4819_WriteRegister(BK4819_REG_09, 0xD0CB);  // CB
-	BK4819_WriteRegister(BK4819_REG_09, 0xE0B5);  // B5
-	BK4819_WriteRegister(BK4819_REG_09, 0xF09F);  // 9F
-#endif
+		( 8u <<  0)},     // AF DAC Gain (after Gain-1 and Gain-2)
+
+	// DTMF coefficients
+	{BK4819_REG_09, 0x006F},  // 111
+	{BK4819_REG_09, 0x106B},  // 107
+	{BK4819_REG_09, 0x2067},  // 103
+	{BK4819_REG_09, 0x3062},  // 98
+	{BK4819_REG_09, 0x4050},  // 80
+	{BK4819_REG_09, 0x5047},  // 71
+	{BK4819_REG_09, 0x603A},  // 58
+	{BK4819_REG_09, 0x702C},  // 44
+	{BK4819_REG_09, 0x8041},  // 65
+	{BK4819_REG_09, 0x9037},  // 55
+	{BK4819_REG_09, 0xA025},  // 37
+	{BK4819_REG_09, 0xB017},  // 23
+	{BK4819_REG_09, 0xC0E4},  // 228
+	{BK4819_REG_09, 0xD0CB},  // 203
+	{BK4819_REG_09, 0xE0B5},  // 181
+	{BK4819_REG_09, 0xF09F},  // 159
+
+	{BK4819_REG_1F, 0x5454},
+	{BK4819_REG_3E, 0xA037},
+
+	{BK4819_REG_33, 0x9000},
+	{BK4819_REG_3F, 0},
+};
+
+void BK4819_Init(void)
+{
+	GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCN);
+	GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCL);
+	GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SDA);
+
+	BK4819_WriteRegisters(BK4819_InitReset, ARRAY_SIZE(BK4819_InitReset));
 
-	BK4819_WriteRegister(BK4819_REG_1F, 0x5454);
-	BK4819_WriteRegister(BK4819_REG_3E, 0xA037);
+	BK4819_SetDefaultAmplifierSettings();
 
 	gBK4819_GpioOutState = 0x9000;
 
-	BK4819_WriteRegister(BK4819_REG_33, 0x9000);
-	BK4819_WriteRegister(BK4819_REG_3F, 0);
+	BK4819_WriteRegisters(BK4819_InitDefaults, ARRAY_SIZE(BK4819_InitDefaults));
 }
 
 static uint16_t BK4819_ReadU16(void)
@@ -147,9 +202,65 @@ static uint16_t BK4819_ReadU16(void)
 	return Value;
 }
 
+static bool BK4819_IsShadowed(BK4819_REGISTER_t Register)
+{
+	switch (Register)
+	{
+		case BK4819_REG_00:     // soft reset
+		case BK4819_REG_02:     // interrupt status
+		case BK4819_REG_09:     // indexed DTMF/tone coefficients
+		case BK4819_REG_0B:
+		case BK4819_REG_0C:
+		case BK4819_REG_0D:
+		case BK4819_REG_0E:
+		case BK4819_REG_59:     // FIFO clear command bits
+		case BK4819_REG_5E:     // FIFO fill level
+		case BK4819_REG_5F:     // FIFO data
+		case BK4819_REG_63:
+		case BK4819_REG_64:
+		case BK4819_REG_65:
+		case BK4819_REG_67:
+		case BK4819_REG_68:
+		case BK4819_REG_69:
+		case BK4819_REG_6A:
+		case BK4819_REG_6F:
+			return false;
+		default:
+			return Register < 0x80;
+	}
+}
+
+void BK4819_InvalidateShadow(void)
+{
+	unsigned int i;
+
+	for (i = 0; i < ARRAY_SIZE(gBK4819_ShadowValid); i++)
+		gBK4819_ShadowValid[i] = 0;
+}
+
+bool BK4819_ShadowPeek(BK4819_REGISTER_t Register, uint16_t *pValue)
+{
+	if (Register >= 0x80 || !(gBK4819_ShadowValid[Register / 32] & (1u << (Register % 32))))
+		return false;
+
+	*pValue = gBK4819_Shadow[Register];
+	return true;
+}
+
 uint16_t BK4819_ReadRegister(BK4819_REGISTER_t Register)
 {
-	uint16_t Value;
+	const bool Shadowed = BK4819_IsShadowed(Register);
+	uint16_t   Value;
+
+	if (Shadowed)
+	{
+		if (gBK4819_ShadowValid[Register / 32] & (1u << (Register % 32)))
+		{
+			gBK4819_ShadowHits++;
+			return gBK4819_Shadow[Register];
+		}
+		gBK4819_ShadowMisses++;
+	}
 
 	GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCN);
 	GPIO_ClearBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCL);
@@ -166,11 +277,32 @@ uint16_t BK4819_ReadRegister(BK4819_REGISTER_t Register)
 	GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCL);
 	GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SDA);
 
+	if (Shadowed)
+	{
+		gBK4819_Shadow[Register] = Value;
+		gBK4819_ShadowValid[Register / 32] |= 1u << (Register % 32);
+	}
+
 	return Value;
 }
 
+static void BK4819_ShadowWrite(BK4819_REGISTER_t Register, uint16_t Data)
+{
+	if (BK4819_IsShadowed(Register))
+	{
+		gBK4819_Shadow[Register] = Data;
+		gBK4819_ShadowValid[Register / 32] |= 1u << (Register % 32);
+	}
+	else if (Register == BK4819_REG_00 && (Data & 0x8000u))
+	{
+		BK4819_InvalidateShadow();   // soft reset puts every register back to its default
+	}
+}
+
 void BK4819_WriteRegister(BK4819_REGISTER_t Register, uint16_t Data)
 {
+	BK4819_ShadowWrite(Register, Data);
+
 	GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCN);
 	GPIO_ClearBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCL);
 
@@ -193,6 +325,59 @@ void BK4819_WriteRegister(BK4819_REGISTER_t Register, uint16_t Data)
 	GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SDA);
 }
 
+// The 24 bits of a frame at the pace BK4819_ReadU16() clocks the chip:
+// 1us of SDA setup with SCL low, 1us with SCL high, the chip samples on
+// the rising edge. The next bit is set right after the falling edge, so
+// the third delay per bit of BK4819_WriteU8()/WriteU16() is left out.
+static void BK4819_WriteFrame(uint8_t Register, uint16_t Value)
+{
+	uint32_t     Data = ((uint32_t)Register << 16) | Value;
+	unsigned int i;
+
+	for (i = 0; i < 24; i++)
+	{
+		if ((Data & 0x800000) == 0)
+			GPIO_ClearBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SDA);
+		else
+			GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SDA);
+
+		SYSTICK_DelayUs(1);
+		GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCL);
+		SYSTICK_DelayUs(1);
+
+		Data <<= 1;
+
+		GPIO_ClearBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCL);
+	}
+}
+
+// Same frames as calling BK4819_WriteRegister() for each entry, but SCL is
+// kept low between them and the bits go out at 2us instead of 3us each, so
+// a frame takes about 50 instead of 77 clock-delay microseconds. SCN goes
+// high 1us after the last falling edge to latch the frame.
+void BK4819_WriteRegisters(const BK4819_RegWrite_t *pList, size_t Count)
+{
+	GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCN);
+	GPIO_ClearBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCL);
+
+	SYSTICK_DelayUs(1);
+
+	for (; Count > 0; Count--, pList++)
+	{
+		BK4819_ShadowWrite(pList->Register, pList->Value);
+
+		GPIO_ClearBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCN);
+		BK4819_WriteFrame(pList->Register, pList->Value);
+		SYSTICK_DelayUs(1);
+		GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCN);
+
+		SYSTICK_DelayUs(1);
+	}
+
+	GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCL);
+	GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SDA);
+}
+
 void BK4819_WriteU8(uint8_t Data)
 {
 	unsigned int i;
@@ -307,16 +492,18 @@ void BK4819_InitAGC(const uint8_t agcType, ModulationMode_t modulation)
 	//         0 = -33dB
 	//
 
+	uint16_t reg49;
+
 	if(modulation==MODULATION_AM)
 	{
 		//AM modulation
 		switch(agcType)
 		{	
 			case RX_AGC_SLOW:
-				BK4819_WriteRegister(BK4819_REG_49, (0 << 14) | (50 << 7) | (15 << 0));
+				reg49 = (0 << 14) | (50 << 7) | (15 << 0);
 				break;
 			case RX_AGC_FAST:
-				BK4819_WriteRegister(BK4819_REG_49, (0 << 14) | (50 << 7) | (25 << 0));
+				reg49 = (0 << 14) | (50 << 7) | (25 << 0);
 				break;
 			default:
 				return;
@@ -328,20 +515,27 @@ void BK4819_InitAGC(const uint8_t agcType, ModulationMode_t modulation)
 		switch(agcType)
 		{	
 			case RX_AGC_SLOW:
-				BK4819_WriteRegister(BK4819_REG_49, (0 << 14) | (84 << 7) | (56 << 0));
+				reg49 = (0 << 14) | (84 << 7) | (56 << 0);
 				break;
 			case RX_AGC_FAST:
-				BK4819_WriteRegister(BK4819_REG_49, (0 << 14) | (84 << 7) | (66 << 0));
+				reg49 = (0 << 14) | (84 << 7) | (66 << 0);
 				break;
 			default:
 				return;
 		}
 	}
-	// switched values to ones from 1o11 am_fix:
-	BK4819_WriteRegister(BK4819_REG_12, 0x0393);  // 0x037B / 000000 11 011 11 011 / -24dB
-	BK4819_WriteRegister(BK4819_REG_11, 0x01B5);  // 0x027B / 000000 10 011 11 011 / -43dB
-	BK4819_WriteRegister(BK4819_REG_10, 0x0145);  // 0x007A / 000000 00 011 11 010 / -58dB
-	BK4819_WriteRegister(BK4819_REG_14, 0x0019);  // 0x0019 / 000000 00 000 11 001 / -84dB
+
+	const BK4819_RegWrite_t agc[] =
+	{
+		{BK4819_REG_49, reg49},
+		// switched values to ones from 1o11 am_fix:
+		{BK4819_REG_12, 0x0393},  // 0x037B / 000000 11 011 11 011 / -24dB
+		{BK4819_REG_11, 0x01B5},  // 0x027B / 000000 10 011 11 011 / -43dB
+		{BK4819_REG_10, 0x0145},  // 0x007A / 000000 00 011 11 010 / -58dB
+		{BK4819_REG_14, 0x0019},  // 0x0019 / 000000 00 000 11 001 / -84dB
+	};
+
+	BK4819_WriteRegisters(agc, ARRAY_SIZE(agc));
 	//30, 10 - doesn't overload but sound low
 	//50, 10 - best so far
 	//50, 15, - SOFT - signal doesn't fall too low - works best for now
@@ -354,14 +548,19 @@ void BK4819_InitAGC(const uint8_t agcType, ModulationMode_t modulation)
 
 
 
-void BK4819_ToggleGpioOut(BK4819_GPIO_PIN_t Pin, bool bSet)
+uint16_t BK4819_SetGpioOutState(BK4819_GPIO_PIN_t Pin, bool bSet)
 {
 	if (bSet)
 		gBK4819_GpioOutState |=  (0x40u >> Pin);
 	else
 		gBK4819_GpioOutState &= ~(0x40u >> Pin);
 
-	BK4819_WriteRegister(BK4819_REG_33, gBK4819_GpioOutState);
+	return gBK4819_GpioOutState;
+}
+
+void BK4819_ToggleGpioOut(BK4819_GPIO_PIN_t Pin, bool bSet)
+{
+	BK4819_WriteRegister(BK4819_REG_33, BK4819_SetGpioOutState(Pin, bSet));
 }
 
 void BK4819_SetCDCSSCodeWord(uint32_t CodeWord)
@@ -617,11 +816,17 @@ void BK4819_SetupPowerAmplifier(uint8_t Bias, uint32_t Frequency) {
 
 void BK4819_SetFrequency(uint32_t Frequency)
 {
-	BK4819_WriteRegister(BK4819_REG_38, (Frequency >>  0) & 0xFFFF);
-	BK4819_WriteRegister(BK4819_REG_39, (Frequency >> 16) & 0xFFFF);
+	const BK4819_RegWrite_t freq[] =
+	{
+		{BK4819_REG_38, (Frequency >>  0) & 0xFFFF},
+		{BK4819_REG_39, (Frequency >> 16) & 0xFFFF},
+	};
+
+	BK4819_WriteRegisters(freq, ARRAY_SIZE(freq));
 }
 
-void BK4819_SetupSquelch(
+size_t BK4819_SquelchWrites(
+		BK4819_RegWrite_t *pList,
 		uint8_t SquelchOpenRSSIThresh,
 		uint8_t SquelchCloseRSSIThresh,
 		uint8_t SquelchOpenNoiseThresh,
@@ -629,77 +834,102 @@ void BK4819_SetupSquelch(
 		uint8_t SquelchCloseGlitchThresh,
 		uint8_t SquelchOpenGlitchThresh)
 {
-	// REG_70
-	//
-	// <15>   0 Enable TONE1
-	//        1 = Enable
-	//        0 = Disable
-	//
-	// <14:8> 0 TONE1 tuning gain
-	//        0 ~ 127
-	//
-	// <7>    0 Enable TONE2
-	//        1 = Enable
-	//        0 = Disable
-	//
-	// <6:0>  0 TONE2/FSK tuning gain
-	//        0 ~ 127
-	//
-	BK4819_WriteRegister(BK4819_REG_70, 0);
+	const BK4819_RegWrite_t squelch[] =
+	{
+		// REG_70
+		//
+		// <15>   0 Enable TONE1
+		//        1 = Enable
+		//        0 = Disable
+		//
+		// <14:8> 0 TONE1 tuning gain
+		//        0 ~ 127
+		//
+		// <7>    0 Enable TONE2
+		//        1 = Enable
+		//        0 = Disable
+		//
+		// <6:0>  0 TONE2/FSK tuning gain
+		//        0 ~ 127
+		//
+		{BK4819_REG_70, 0},
 
-	// Glitch threshold for Squelch = close
-	//
-	// 0 ~ 255
-	//
-	BK4819_WriteRegister(BK4819_REG_4D, 0xA000 | SquelchCloseGlitchThresh);
+		// Glitch threshold for Squelch = close
+		//
+		// 0 ~ 255
+		//
+		{BK4819_REG_4D, 0xA000 | SquelchCloseGlitchThresh},
 
-	// REG_4E
-	//
-	// <15:14> 1 ???
-	//
-	// <13:11> 5 Squelch = open  Delay Setting
-	//         0 ~ 7
-	//
-	// <10:9>  7 Squelch = close Delay Setting
-	//         0 ~ 3
-	//
-	// <8>     0 ???
-	//
-	// <7:0>   8 Glitch threshold for Squelch = open
-	//         0 ~ 255
-	//
-	BK4819_WriteRegister(BK4819_REG_4E,  // 01 101 11 1 00000000
+		// REG_4E
+		//
+		// <15:14> 1 ???
+		//
+		// <13:11> 5 Squelch = open  Delay Setting
+		//         0 ~ 7
+		//
+		// <10:9>  7 Squelch = close Delay Setting
+		//         0 ~ 3
+		//
+		// <8>     0 ???
+		//
+		// <7:0>   8 Glitch threshold for Squelch = open
+		//         0 ~ 255
+		//
+		{BK4819_REG_4E,  // 01 101 11 1 00000000
 
-		// original (*)
-	(1u << 14) |                  //  1 ???
-	(5u << 11) |                  // *5  squelch = open  delay .. 0 ~ 7
-	(3u <<  9) |                  // *3  squelch = close delay .. 0 ~ 3
-	SquelchOpenGlitchThresh);     //  0 ~ 255
+			// original (*)
+		(1u << 14) |                  //  1 ???
+		(5u << 11) |                  // *5  squelch = open  delay .. 0 ~ 7
+		(3u <<  9) |                  // *3  squelch = close delay .. 0 ~ 3
+		SquelchOpenGlitchThresh},     //  0 ~ 255
 
+		// REG_4F
+		//
+		// <14:8> 47 Ex-noise threshold for Squelch = close
+		//        0 ~ 127
+		//
+		// <7>    ???
+		//
+		// <6:0>  46 Ex-noise threshold for Squelch = open
+		//        0 ~ 127
+		//
+		{BK4819_REG_4F, ((uint16_t)SquelchCloseNoiseThresh << 8) | SquelchOpenNoiseThresh},
 
-	// REG_4F
-	//
-	// <14:8> 47 Ex-noise threshold for Squelch = close
-	//        0 ~ 127
-	//
-	// <7>    ???
-	//
-	// <6:0>  46 Ex-noise threshold for Squelch = open
-	//        0 ~ 127
-	//
-	BK4819_WriteRegister(BK4819_REG_4F, ((uint16_t)SquelchCloseNoiseThresh << 8) | SquelchOpenNoiseThresh);
+		// REG_78
+		//
+		// <15:8> 72 RSSI threshold for Squelch = open    0.5dB/step
+		//
+		// <7:0>  70 RSSI threshold for Squelch = close   0.5dB/step
+		//
+		{BK4819_REG_78, ((uint16_t)SquelchOpenRSSIThresh   << 8) | SquelchCloseRSSIThresh},
 
-	// REG_78
-	//
-	// <15:8> 72 RSSI threshold for Squelch = open    0.5dB/step
-	//
-	// <7:0>  70 RSSI threshold for Squelch = close   0.5dB/step
-	//
-	BK4819_WriteRegister(BK4819_REG_78, ((uint16_t)SquelchOpenRSSIThresh   << 8) | SquelchCloseRSSIThresh);
+		{BK4819_REG_47, BK4819_AFValue(BK4819_AF_MUTE)},
+	};
+	size_t Count = 0;
+	size_t i;
 
-	BK4819_SetAF(BK4819_AF_MUTE);
+	for (i = 0; i < ARRAY_SIZE(squelch); i++)
+		pList[Count++] = squelch[i];
+	for (i = 0; i < ARRAY_SIZE(BK4819_RxOn); i++)
+		pList[Count++] = BK4819_RxOn[i];
 
-	BK4819_RX_TurnOn();
+	return Count;
+}
+
+void BK4819_SetupSquelch(
+		uint8_t SquelchOpenRSSIThresh,
+		uint8_t SquelchCloseRSSIThresh,
+		uint8_t SquelchOpenNoiseThresh,
+		uint8_t SquelchCloseNoiseThresh,
+		uint8_t SquelchCloseGlitchThresh,
+		uint8_t SquelchOpenGlitchThresh)
+{
+	BK4819_RegWrite_t squelch[BK4819_SQUELCH_WRITES];
+
+	BK4819_WriteRegisters(squelch, BK4819_SquelchWrites(squelch,
+		SquelchOpenRSSIThresh,    SquelchCloseRSSIThresh,
+		SquelchOpenNoiseThresh,   SquelchCloseNoiseThresh,
+		SquelchCloseGlitchThresh, SquelchOpenGlitchThresh));
 }
 
 // Set RF RX front end gain original QS front end register settings
@@ -712,11 +942,7 @@ void BK4819_SetDefaultAmplifierSettings()
 
 void BK4819_SetAF(BK4819_AF_Type_t AF)
 {
-	// AF Output Inverse Mode = Inverse
-	// Undocumented bits 0x2040
-	//
-//	BK4819_WriteRegister(BK4819_REG_47, 0x6040 | (AF << 8));
-	BK4819_WriteRegister(BK4819_REG_47, (6u << 12) | (AF << 8) | (1u << 6));
+	BK4819_WriteRegister(BK4819_REG_47, BK4819_AFValue(AF));
 }
 
 void BK4819_SetRegValue(RegisterSpec s, uint16_t v) {
@@ -727,57 +953,31 @@ void BK4819_SetRegValue(RegisterSpec s, uint16_t v) {
 
 void BK4819_RX_TurnOn(void)
 {
-	// DSP Voltage Setting = 1
-	// ANA LDO = 2.7v
-	// VCO LDO = 2.7v
-	// RF LDO  = 2.7v
-	// PLL LDO = 2.7v
-	// ANA LDO bypass
-	// VCO LDO bypass
-	// RF LDO  bypass
-	// PLL LDO bypass
-	// Reserved bit is 1 instead of 0
-	// Enable  DSP
-	// Enable  XTAL
-	// Enable  Band Gap
-	//
-	BK4819_WriteRegister(BK4819_REG_37, 0x1F0F);  // 0001111100001111
-
-	// Turn off everything
-	BK4819_WriteRegister(BK4819_REG_30, 0);
-
-
-	BK4819_WriteRegister(BK4819_REG_30, 
-		BK4819_REG_30_ENABLE_VCO_CALIB |
-		BK4819_REG_30_DISABLE_UNKNOWN |
-		BK4819_REG_30_ENABLE_RX_LINK |
-		BK4819_REG_30_ENABLE_AF_DAC |
-		BK4819_REG_30_ENABLE_DISC_MODE |
-		BK4819_REG_30_ENABLE_PLL_VCO |
-		BK4819_REG_30_DISABLE_PA_GAIN |
-		BK4819_REG_30_DISABLE_MIC_ADC |
-		BK4819_REG_30_DISABLE_TX_DSP |
-		BK4819_REG_30_ENABLE_RX_DSP );
+	BK4819_WriteRegisters(BK4819_RxOn, ARRAY_SIZE(BK4819_RxOn));
 }
 
-void BK4819_PickRXFilterPathBasedOnFrequency(uint32_t Frequency)
+uint16_t BK4819_SetRXFilterPathState(uint32_t Frequency)
 {
 	if (Frequency < 28000000)
 	{	// VHF
-		BK4819_ToggleGpioOut(BK4819_GPIO4_PIN32_VHF_LNA, true);
-		BK4819_ToggleGpioOut(BK4819_GPIO3_PIN31_UHF_LNA, false);
+		BK4819_SetGpioOutState(BK4819_GPIO4_PIN32_VHF_LNA, true);
+		return BK4819_SetGpioOutState(BK4819_GPIO3_PIN31_UHF_LNA, false);
 	}
-	else
+
 	if (Frequency == 0xFFFFFFFF)
 	{	// OFF
-		BK4819_ToggleGpioOut(BK4819_GPIO4_PIN32_VHF_LNA, false);
-		BK4819_ToggleGpioOut(BK4819_GPIO3_PIN31_UHF_LNA, false);
-	}
-	else
-	{	// UHF
-		BK4819_ToggleGpioOut(BK4819_GPIO4_PIN32_VHF_LNA, false);
-		BK4819_ToggleGpioOut(BK4819_GPIO3_PIN31_UHF_LNA, true);
+		BK4819_SetGpioOutState(BK4819_GPIO4_PIN32_VHF_LNA, false);
+		return BK4819_SetGpioOutState(BK4819_GPIO3_PIN31_UHF_LNA, false);
 	}
+
+	// UHF
+	BK4819_SetGpioOutState(BK4819_GPIO4_PIN32_VHF_LNA, false);
+	return BK4819_SetGpioOutState(BK4819_GPIO3_PIN31_UHF_LNA, true);
+}
+
+void BK4819_PickRXFilterPathBasedOnFrequency(uint32_t Frequency)
+{
+	BK4819_WriteRegister(BK4819_REG_33, BK4819_SetRXFilterPathState(Frequency));
 }
 
 void BK4819_DisableScramble(void)
@@ -1587,6 +1787,49 @@ uint8_t BK4819_GetCTCType(void)
 	return (BK4819_ReadRegister(BK4819_REG_0C) >> 10) & 3u;
 }
 
+// Interrupt events waiting for the main loop. BK4819_PollInterrupts is the
+// only writer of gEventHead and the consumer the only writer of gEventTail,
+// so the two sides never need to lock each other out.
+static BK4819_Event_t   gEvents[BK4819_EVENT_RING_SIZE];
+static volatile uint8_t gEventHead;
+static volatile uint8_t gEventTail;
+
+void BK4819_PollInterrupts(void)
+{
+	// an event only gets acknowledged once there is room for it, the chip
+	// keeps the rest flagged in REG_0C until the next poll
+	while ((uint8_t)(gEventHead - gEventTail) < BK4819_EVENT_RING_SIZE &&
+	       (BK4819_ReadRegister(BK4819_REG_0C) & 1u))
+	{
+		BK4819_Event_t *pEvent = &gEvents[gEventHead % BK4819_EVENT_RING_SIZE];
+
+		// clearing REG_02 latches the status bits and drops the request
+		BK4819_WriteRegister(BK4819_REG_02, 0);
+		pEvent->Status    = BK4819_ReadRegister(BK4819_REG_02);
+		pEvent->CtcShift  = BK4819_GetCTCShift();
+		pEvent->Dtmf      = (pEvent->Status & BK4819_REG_02_DTMF_5TONE_FOUND) ? BK4819_GetDTMF_5TONE_Code() : 0;
+		pEvent->CdcssType = (pEvent->Status & BK4819_REG_02_CDCSS_LOST) ? BK4819_GetCDCSSCodeType() : 0;
+
+		gEventHead++;
+	}
+}
+
+bool BK4819_EventPending(void)
+{
+	return gEventHead != gEventTail;
+}
+
+bool BK4819_GetEvent(BK4819_Event_t *pEvent)
+{
+	if (gEventHead == gEventTail)
+		return false;
+
+	*pEvent = gEvents[gEventTail % BK4819_EVENT_RING_SIZE];
+	gEventTail++;
+
+	return true;
+}
+
 void BK4819_SendFSKData(uint16_t *pData)
 {
 	unsigned int i;
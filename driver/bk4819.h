@@ -21,6 +21,7 @@
 #define DRIVER_BK4819_h
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 #include "radio.h"
 
@@ -57,6 +58,18 @@ enum BK4819_FilterBandwidth_t
 	BK4819_FILTER_BW_NARROWEST = 4U
 };
 
+// must be a power of two so the free-running indexes wrap cleanly
+#define BK4819_EVENT_RING_SIZE 8u
+
+// one acknowledged interrupt, together with the registers that only hold
+// their value until the next one comes in
+typedef struct {
+	uint16_t Status;      // REG_02 interrupt bits
+	uint8_t  CtcShift;    // CTCSS phase shift
+	uint8_t  Dtmf;        // DTMF/5-tone code when DTMF_5TONE_FOUND is set
+	uint8_t  CdcssType;   // CDCSS code type when CDCSS_LOST is set
+} BK4819_Event_t;
+
 typedef enum BK4819_FilterBandwidth_t BK4819_FilterBandwidth_t;
 
 enum BK4819_CssScanResult_t
@@ -68,12 +81,27 @@ enum BK4819_CssScanResult_t
 
 typedef enum BK4819_CssScanResult_t BK4819_CssScanResult_t;
 
+typedef struct
+{
+	BK4819_REGISTER_t Register;
+	uint16_t          Value;
+} BK4819_RegWrite_t;
+
 // radio is asleep, not listening
 extern bool gRxIdleMode;
 
+// reads served from the register shadow / reads that had to go to the chip
+extern uint32_t gBK4819_ShadowHits;
+extern uint32_t gBK4819_ShadowMisses;
+
 void     BK4819_Init(void);
 uint16_t BK4819_ReadRegister(BK4819_REGISTER_t Register);
 void     BK4819_WriteRegister(BK4819_REGISTER_t Register, uint16_t Data);
+void     BK4819_WriteRegisters(const BK4819_RegWrite_t *pList, size_t Count);
+void     BK4819_InvalidateShadow(void);
+// shadowed value of Register without touching the chip or the hit counters,
+// false if the shadow holds nothing for it
+bool     BK4819_ShadowPeek(BK4819_REGISTER_t Register, uint16_t *pValue);
 void     BK4819_SetRegValue(RegisterSpec s, uint16_t v);
 void     BK4819_WriteU8(uint8_t Data);
 void     BK4819_WriteU16(uint16_t Data);
@@ -81,6 +109,8 @@ void     BK4819_WriteU16(uint16_t Data);
 void     BK4819_SetAGC(bool enable);
 void     BK4819_InitAGC(const uint8_t agcType, ModulationMode_t modulation);
 
+// updates the GPIO output state without writing it, returns the REG_33 value
+uint16_t BK4819_SetGpioOutState(BK4819_GPIO_PIN_t Pin, bool bSet);
 void     BK4819_ToggleGpioOut(BK4819_GPIO_PIN_t Pin, bool bSet);
 
 void     BK4819_SetCDCSSCodeWord(uint32_t CodeWord);
@@ -91,6 +121,17 @@ void     BK4819_SetFilterBandwidth(const BK4819_FilterBandwidth_t Bandwidth, con
 void     BK4819_SetupPowerAmplifier(const uint8_t bias, const uint32_t frequency);
 void     BK4819_SetDefaultAmplifierSettings();
 void     BK4819_SetFrequency(uint32_t Frequency);
+// fills pList with the frames of BK4819_SetupSquelch(), for callers that
+// batch them with more writes, returns how many (BK4819_SQUELCH_WRITES)
+#define BK4819_SQUELCH_WRITES 9
+size_t   BK4819_SquelchWrites(
+			BK4819_RegWrite_t *pList,
+			uint8_t SquelchOpenRSSIThresh,
+			uint8_t SquelchCloseRSSIThresh,
+			uint8_t SquelchOpenNoiseThresh,
+			uint8_t SquelchCloseNoiseThresh,
+			uint8_t SquelchCloseGlitchThresh,
+			uint8_t SquelchOpenGlitchThresh);
 void     BK4819_SetupSquelch(
 			uint8_t SquelchOpenRSSIThresh,
 			uint8_t SquelchCloseRSSIThresh,
@@ -101,6 +142,7 @@ void     BK4819_SetupSquelch(
 
 void     BK4819_SetAF(BK4819_AF_Type_t AF);
 void     BK4819_RX_TurnOn(void);
+uint16_t BK4819_SetRXFilterPathState(uint32_t Frequency);
 void     BK4819_PickRXFilterPathBasedOnFrequency(uint32_t Frequency);
 void     BK4819_DisableScramble(void);
 void     BK4819_EnableScramble(uint8_t Type);
@@ -168,6 +210,10 @@ uint8_t  BK4819_GetCDCSSCodeType(void);
 uint8_t  BK4819_GetCTCShift(void);
 uint8_t  BK4819_GetCTCType(void);
 
+void     BK4819_PollInterrupts(void);
+bool     BK4819_EventPending(void);
+bool     BK4819_GetEvent(BK4819_Event_t *pEvent);
+
 void     BK4819_SendFSKData(uint16_t *pData);
 void     BK4819_PrepareFSKReceive(void);
 	    
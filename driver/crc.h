@@ -24,6 +24,7 @@
 
 void CRC_Init(void);
 uint16_t CRC_Calculate(const void *pBuffer, uint16_t Size);
+uint16_t CRC_Update(uint16_t Crc, const void *pBuffer, uint16_t Size);
 
 #endif
 
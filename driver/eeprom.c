@@ -20,14 +20,66 @@
 #include <stddef.h>
 #include <string.h>
 
+#include "driver/crc.h"
 #include "driver/eeprom.h"
 #include "driver/i2c.h"
-#include "driver/system.h"
 
 // EEPROM calibration tables start here
 #define EEPROM_WRITE_MAX_ADDR 0x1E00
 
-void EEPROM_ReadBuffer(uint16_t Address, void *pBuffer, uint8_t Size)
+// one ACK poll takes a few dozen us, this is well over the 5ms write cycle
+#define EEPROM_POLL_LIMIT     1000U
+
+#define EEPROM_CACHE_LINES    8U
+#define EEPROM_LINE_SIZE      8U
+#define EEPROM_LINE_FREE      0xFFFFU
+
+// Write-back cache for the 8 byte EEPROM_WriteBuffer() blocks. Saving the
+// same block again only updates the RAM copy, the chip is written once the
+// block has not changed for a whole 500ms slice, or at EEPROM_Flush().
+typedef struct {
+	uint16_t Address;
+	bool     Fresh;    // written since the last EEPROM_TimeSlice500ms()
+	uint8_t  Data[EEPROM_LINE_SIZE];
+} EEPROM_Line_t;
+
+static EEPROM_Line_t gEEPROM_Cache[EEPROM_CACHE_LINES] = {
+	[0 ... EEPROM_CACHE_LINES - 1] = { .Address = EEPROM_LINE_FREE },
+};
+
+// Journal for the blocks that change on every knob turn or scan stop: the
+// VFO indices (0x0E80), the FM frequency (0x0E88) and the VFO blocks
+// (0x0C80..0x0D5F). Instead of rewriting their home location, each change
+// is appended as a record to a ring of 16 records, so the wear is spread
+// over 8 pages. When the ring is full the newest values are written home
+// and a barrier record starts the next round; records older than the last
+// barrier are ignored. A record torn by a power loss fails its CRC and is
+// skipped, the previous value of that block wins.
+#define EEPROM_JOURNAL_ADDR     0x1D00U    // free, the 16 DTMF contacts end at 0x1CFF
+#define EEPROM_JOURNAL_RECORDS  16U
+#define EEPROM_JOURNAL_END      (EEPROM_JOURNAL_ADDR + EEPROM_JOURNAL_RECORDS * sizeof(EEPROM_Record_t))
+#define EEPROM_JOURNAL_KEYS     30U
+#define EEPROM_JOURNAL_BARRIER  0x0000U
+
+typedef struct {
+	uint32_t Sequence;
+	uint16_t Address;
+	uint8_t  Data[EEPROM_LINE_SIZE];
+	uint16_t Crc;
+} EEPROM_Record_t;
+
+static uint8_t  gJournalData[EEPROM_JOURNAL_KEYS][EEPROM_LINE_SIZE];
+static uint32_t gJournalLive;      // keys whose newest value is in the journal
+static uint32_t gJournalSequence;  // of the next record
+static uint8_t  gJournalHead;      // slot of the next record
+static uint8_t  gJournalCount;     // records since the last barrier, including it
+
+// EEPROM_MapImage() region, EEPROM_ReadBuffer() serves it from RAM
+static const uint8_t *gImageData;
+static uint16_t       gImageAddress;
+static uint16_t       gImageSize;
+
+static void EEPROM_ReadChip(uint16_t Address, void *pBuffer, uint16_t Size)
 {
 	I2C_Start();
 
@@ -45,29 +97,407 @@ void EEPROM_ReadBuffer(uint16_t Address, void *pBuffer, uint8_t Size)
 	I2C_Stop();
 }
 
+// Works out the overlapping part of [Address, Address + Size) and the 8 byte
+// line at Line, returns false if they don't overlap
+static bool EEPROM_Overlap(uint16_t Line, uint16_t Address, uint16_t Size, uint16_t *pStart, uint16_t *pEnd)
+{
+	if (Line == EEPROM_LINE_FREE ||
+	    Line >= Address + Size ||
+	    Line + EEPROM_LINE_SIZE <= Address)
+		return false;
+
+	*pStart = (Line > Address) ? Line : Address;
+	*pEnd   = (Line + EEPROM_LINE_SIZE < Address + Size) ? Line + EEPROM_LINE_SIZE : Address + Size;
+
+	return true;
+}
+
+static int EEPROM_JournalKey(uint16_t Address)
+{
+	if (Address == 0x0E80)
+		return 0;
+	if (Address == 0x0E88)
+		return 1;
+	if (Address >= 0x0C80 && Address < 0x0D60 && (Address % EEPROM_LINE_SIZE) == 0)
+		return 2 + (Address - 0x0C80) / EEPROM_LINE_SIZE;
+	return -1;
+}
+
+static uint16_t EEPROM_JournalAddress(unsigned int Key)
+{
+	if (Key == 0)
+		return 0x0E80;
+	if (Key == 1)
+		return 0x0E88;
+	return 0x0C80 + (Key - 2) * EEPROM_LINE_SIZE;
+}
+
+// Blocks held by the journal are newer than their home location
+static void EEPROM_JournalOverlay(uint16_t Address, uint8_t *pData, uint16_t Size)
+{
+	for (unsigned int i = 0; i < EEPROM_JOURNAL_KEYS; i++) {
+		const uint16_t Line = EEPROM_JournalAddress(i);
+		uint16_t Start, End;
+
+		if ((gJournalLive & (1U << i)) && EEPROM_Overlap(Line, Address, Size, &Start, &End))
+			memcpy(pData + (Start - Address), gJournalData[i] + (Start - Line), End - Start);
+	}
+}
+
+// Pending writes are newer than both
+static void EEPROM_CacheOverlay(uint16_t Address, uint8_t *pData, uint16_t Size)
+{
+	for (unsigned int i = 0; i < EEPROM_CACHE_LINES; i++) {
+		const EEPROM_Line_t *pLine = &gEEPROM_Cache[i];
+		uint16_t Start, End;
+
+		if (EEPROM_Overlap(pLine->Address, Address, Size, &Start, &End))
+			memcpy(pData + (Start - Address), pLine->Data + (Start - pLine->Address), End - Start);
+	}
+}
+
+void EEPROM_ReadBuffer(uint16_t Address, void *pBuffer, uint8_t Size)
+{
+	uint8_t  *pData = (uint8_t *)pBuffer;
+	const int Key   = EEPROM_JournalKey(Address);
+
+	if (gImageData != NULL && Address >= gImageAddress && Address + Size <= gImageAddress + gImageSize) {
+		memcpy(pData, gImageData + (Address - gImageAddress), Size);
+	} else if (Size == EEPROM_LINE_SIZE && Key >= 0 && (gJournalLive & (1U << Key))) {
+		memcpy(pData, gJournalData[Key], EEPROM_LINE_SIZE);
+	} else {
+		EEPROM_ReadChip(Address, pBuffer, Size);
+		EEPROM_JournalOverlay(Address, pData, Size);
+	}
+
+	EEPROM_CacheOverlay(Address, pData, Size);
+}
+
+/*
+Reads Size bytes in one transaction and serves EEPROM_ReadBuffer() calls
+within that range from pBuffer until EEPROM_UnmapImage(). Only meant for
+the boot time parsers, the image does not follow EEPROM_WriteBlock()
+*/
+void EEPROM_MapImage(uint16_t Address, void *pBuffer, uint16_t Size)
+{
+	EEPROM_ReadChip(Address, pBuffer, Size);
+	EEPROM_JournalOverlay(Address, pBuffer, Size);
+
+	gImageData    = pBuffer;
+	gImageAddress = Address;
+	gImageSize    = Size;
+}
+
+void EEPROM_UnmapImage(void)
+{
+	gImageData = NULL;
+}
+
+// Wait for the write cycle to finish. The chip does not acknowledge its
+// address while it is burning a page in (up to 5ms), so keep addressing it
+// until it does instead of sleeping for the worst case.
+static void EEPROM_WaitReady(void)
+{
+	for (uint16_t i = 0; i < EEPROM_POLL_LIMIT; i++) {
+		int ack;
+
+		I2C_Start();
+		ack = I2C_Write(0xA0);
+		I2C_Stop();
+
+		if (ack == 0)
+			return;
+	}
+}
+
+static void EEPROM_WriteChip(uint16_t Address, const uint8_t *pData, uint16_t Size)
+{
+	while (Size > 0) {
+		// the address counter wraps within a page, so a write must not cross one
+		uint8_t Length = EEPROM_PAGE_SIZE - (Address % EEPROM_PAGE_SIZE);
+		uint8_t buffer[EEPROM_PAGE_SIZE];
+
+		if (Length > Size)
+			Length = Size;
+
+		EEPROM_ReadChip(Address, buffer, Length);
+		if (memcmp(pData, buffer, Length) != 0)
+		{
+			I2C_Start();
+			I2C_Write(0xA0);
+			I2C_Write((Address >> 8) & 0xFF);
+			I2C_Write((Address >> 0) & 0xFF);
+			I2C_WriteBuffer(pData, Length);
+			I2C_Stop();
+
+			EEPROM_WaitReady();
+		}
+
+		Address += Length;
+		pData   += Length;
+		Size    -= Length;
+	}
+}
+
+static void EEPROM_JournalCompact(void);
+
+static void EEPROM_JournalAppend(uint16_t Address, const uint8_t *pData)
+{
+	EEPROM_Record_t Record;
+
+	if (gJournalCount >= EEPROM_JOURNAL_RECORDS)
+		EEPROM_JournalCompact();
+
+	Record.Sequence = gJournalSequence++;
+	Record.Address  = Address;
+	memcpy(Record.Data, pData, EEPROM_LINE_SIZE);
+	Record.Crc      = CRC_Calculate(&Record, offsetof(EEPROM_Record_t, Crc));
+
+	EEPROM_WriteChip(EEPROM_JOURNAL_ADDR + gJournalHead * sizeof(Record), (const uint8_t *)&Record, sizeof(Record));
+
+	gJournalHead = (gJournalHead + 1) % EEPROM_JOURNAL_RECORDS;
+	gJournalCount++;
+}
+
+// Writes the journalled blocks home and starts a new round
+static void EEPROM_JournalCompact(void)
+{
+	static const uint8_t Barrier[EEPROM_LINE_SIZE] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+
+	for (unsigned int i = 0; i < EEPROM_JOURNAL_KEYS; i++)
+		if (gJournalLive & (1U << i))
+			EEPROM_WriteChip(EEPROM_JournalAddress(i), gJournalData[i], EEPROM_LINE_SIZE);
+
+	gJournalLive  = 0;
+	gJournalCount = 0;
+
+	EEPROM_JournalAppend(EEPROM_JOURNAL_BARRIER, Barrier);
+}
+
+static void EEPROM_JournalWrite(unsigned int Key, const uint8_t *pData)
+{
+	uint8_t Current[EEPROM_LINE_SIZE];
+
+	if (gJournalLive & (1U << Key))
+		memcpy(Current, gJournalData[Key], EEPROM_LINE_SIZE);
+	else
+		EEPROM_ReadChip(EEPROM_JournalAddress(Key), Current, EEPROM_LINE_SIZE);
+
+	if (memcmp(Current, pData, EEPROM_LINE_SIZE) == 0)
+		return;
+
+	// may compact, which writes the previous value home
+	EEPROM_JournalAppend(EEPROM_JournalAddress(Key), pData);
+
+	memcpy(gJournalData[Key], pData, EEPROM_LINE_SIZE);
+	gJournalLive |= 1U << Key;
+}
+
+void EEPROM_JournalInit(void)
+{
+	EEPROM_Record_t Records[EEPROM_JOURNAL_RECORDS];
+	uint32_t        Newest[EEPROM_JOURNAL_KEYS];
+	uint32_t        Barrier = 0;
+	uint32_t        Oldest  = 0;
+	uint32_t        Last    = 0;
+
+	EEPROM_ReadChip(EEPROM_JOURNAL_ADDR, Records, sizeof(Records));
+	memset(Newest, 0, sizeof(Newest));
+
+	gJournalLive = 0;
+	gJournalHead = 0;
+
+	for (unsigned int Slot = 0; Slot < EEPROM_JOURNAL_RECORDS; Slot++) {
+		const EEPROM_Record_t Record = Records[Slot];
+		int Key;
+
+		if (Record.Crc != CRC_Calculate(&Record, offsetof(EEPROM_Record_t, Crc)))
+			continue;
+
+		if (Record.Sequence > Last) {
+			Last         = Record.Sequence;
+			gJournalHead = (Slot + 1) % EEPROM_JOURNAL_RECORDS;
+		}
+		if (Oldest == 0 || Record.Sequence < Oldest)
+			Oldest = Record.Sequence;
+
+		if (Record.Address == EEPROM_JOURNAL_BARRIER) {
+			if (Record.Sequence > Barrier)
+				Barrier = Record.Sequence;
+			continue;
+		}
+
+		Key = EEPROM_JournalKey(Record.Address);
+		if (Key >= 0 && Record.Sequence > Newest[Key]) {
+			Newest[Key] = Record.Sequence;
+			memcpy(gJournalData[Key], Record.Data, EEPROM_LINE_SIZE);
+		}
+	}
+
+	for (unsigned int i = 0; i < EEPROM_JOURNAL_KEYS; i++)
+		if (Newest[i] > Barrier)
+			gJournalLive |= 1U << i;
+
+	gJournalSequence = Last + 1;
+	gJournalCount    = (Last == 0) ? 0 : Last - (Barrier ? Barrier : Oldest) + 1;
+	if (gJournalCount > EEPROM_JOURNAL_RECORDS)
+		gJournalCount = EEPROM_JOURNAL_RECORDS;
+}
+
+/*
+Writes Size bytes to EEPROM straight away, split at the page boundaries
+Address: EEPROM address
+pBuffer: value
+Size: number of bytes
+safe: if set to false will allow overwriting calibration data
+*/
+void EEPROM_WriteBlock(uint16_t Address, const void *pBuffer, uint16_t Size, const bool safe)
+{
+	const uint8_t *pData = (const uint8_t *)pBuffer;
+
+	if (pBuffer == NULL || (safe && Address >= EEPROM_WRITE_MAX_ADDR))
+		return;
+
+	if (safe && Address + Size > EEPROM_WRITE_MAX_ADDR)
+		Size = EEPROM_WRITE_MAX_ADDR - Address;
+
+	// the journal belongs to this driver, an image written over it (UART,
+	// air copy) must not bring back records that don't match its blocks
+	if (Address < EEPROM_JOURNAL_END && Address + Size > EEPROM_JOURNAL_ADDR) {
+		if (Address < EEPROM_JOURNAL_ADDR)
+			EEPROM_WriteBlock(Address, pData, EEPROM_JOURNAL_ADDR - Address, safe);
+		if (Address + Size > EEPROM_JOURNAL_END)
+			EEPROM_WriteBlock(EEPROM_JOURNAL_END, pData + (EEPROM_JOURNAL_END - Address), Address + Size - EEPROM_JOURNAL_END, safe);
+		return;
+	}
+
+	// the home location becomes the newest copy again
+	for (unsigned int i = 0; i < EEPROM_JOURNAL_KEYS; i++) {
+		uint16_t Start, End;
+
+		if ((gJournalLive & (1U << i)) && EEPROM_Overlap(EEPROM_JournalAddress(i), Address, Size, &Start, &End)) {
+			EEPROM_JournalCompact();
+			break;
+		}
+	}
+
+	// keep pending lines coherent, they are written again later
+	for (unsigned int i = 0; i < EEPROM_CACHE_LINES; i++) {
+		EEPROM_Line_t *pLine = &gEEPROM_Cache[i];
+		uint16_t Start, End;
+
+		if (EEPROM_Overlap(pLine->Address, Address, Size, &Start, &End))
+			memcpy(pLine->Data + (Start - pLine->Address), pData + (Start - Address), End - Start);
+	}
+
+	EEPROM_WriteChip(Address, pData, Size);
+}
+
+// Writes out a pending line together with the lines that directly follow it
+static void EEPROM_FlushRun(EEPROM_Line_t *pFirst)
+{
+	uint8_t  buffer[EEPROM_PAGE_SIZE];
+	uint16_t Address = pFirst->Address;
+	uint8_t  Length  = 0;
+	bool     Found;
+
+	do {
+		Found = false;
+		for (unsigned int i = 0; i < EEPROM_CACHE_LINES; i++) {
+			EEPROM_Line_t *pLine = &gEEPROM_Cache[i];
+
+			if (pLine->Address == Address + Length && EEPROM_JournalKey(pLine->Address) < 0) {
+				memcpy(buffer + Length, pLine->Data, EEPROM_LINE_SIZE);
+				pLine->Address = EEPROM_LINE_FREE;
+				Length += EEPROM_LINE_SIZE;
+				Found = true;
+				break;
+			}
+		}
+	} while (Found && Length + EEPROM_LINE_SIZE <= sizeof(buffer));
+
+	EEPROM_WriteChip(Address, buffer, Length);
+}
+
+static void EEPROM_FlushLines(bool bAll)
+{
+	while (1) {
+		EEPROM_Line_t *pFirst = NULL;
+
+		for (unsigned int i = 0; i < EEPROM_CACHE_LINES; i++) {
+			EEPROM_Line_t *pLine = &gEEPROM_Cache[i];
+
+			if (pLine->Address == EEPROM_LINE_FREE || (!bAll && pLine->Fresh))
+				continue;
+			if (pFirst == NULL || pLine->Address < pFirst->Address)
+				pFirst = pLine;
+		}
+
+		if (pFirst == NULL)
+			return;
+
+		const int Key = EEPROM_JournalKey(pFirst->Address);
+		if (Key >= 0) {
+			EEPROM_JournalWrite(Key, pFirst->Data);
+			pFirst->Address = EEPROM_LINE_FREE;
+		} else {
+			EEPROM_FlushRun(pFirst);
+		}
+	}
+}
+
+void EEPROM_Flush(void)
+{
+	EEPROM_FlushLines(true);
+}
+
+void EEPROM_TimeSlice500ms(void)
+{
+	EEPROM_FlushLines(false);
+
+	for (unsigned int i = 0; i < EEPROM_CACHE_LINES; i++)
+		gEEPROM_Cache[i].Fresh = false;
+}
+
 /*
-Writes to EEPROM
+Writes 8 bytes to EEPROM, the write is held back in RAM for a while
 Address: EEPROM address
 pBuffer: value
 safe: if set to false will allow overwriting calibration data
 */
 void EEPROM_WriteBuffer(uint16_t Address, const void *pBuffer, const bool safe)
 {
+	EEPROM_Line_t *pFree = NULL;
+
 	if (pBuffer == NULL || (safe && Address >= EEPROM_WRITE_MAX_ADDR))
 		return;
 
-	uint8_t buffer[8];
-	EEPROM_ReadBuffer(Address, buffer, 8);
-	if (memcmp(pBuffer, buffer, 8) != 0)
-	{
-		I2C_Start();
-		I2C_Write(0xA0);
-		I2C_Write((Address >> 8) & 0xFF);
-		I2C_Write((Address >> 0) & 0xFF);
-		I2C_WriteBuffer(pBuffer, 8);
-		I2C_Stop();
+	for (unsigned int i = 0; i < EEPROM_CACHE_LINES; i++) {
+		EEPROM_Line_t *pLine = &gEEPROM_Cache[i];
+		uint16_t Start, End;
+
+		if (pLine->Address == Address) {
+			memcpy(pLine->Data, pBuffer, EEPROM_LINE_SIZE);
+			pLine->Fresh = true;
+			return;
+		}
+
+		if (EEPROM_Overlap(pLine->Address, Address, EEPROM_LINE_SIZE, &Start, &End)) {
+			// a misaligned block, don't let two lines cover the same bytes
+			EEPROM_WriteBlock(Address, pBuffer, EEPROM_LINE_SIZE, safe);
+			return;
+		}
+
+		if (pLine->Address == EEPROM_LINE_FREE && pFree == NULL)
+			pFree = pLine;
+	}
+
+	if (pFree == NULL) {
+		EEPROM_Flush();
+		pFree = &gEEPROM_Cache[0];
 	}
 
-	// give the EEPROM time to burn the data in (apparently takes 5ms)
-	SYSTEM_DelayMs(8);
+	pFree->Address = Address;
+	pFree->Fresh   = true;
+	memcpy(pFree->Data, pBuffer, EEPROM_LINE_SIZE);
 }
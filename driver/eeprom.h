@@ -23,8 +23,17 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+// 24C64, a page write must stay within one page
+#define EEPROM_PAGE_SIZE 32U
+
+void EEPROM_JournalInit(void);
 void EEPROM_ReadBuffer(uint16_t Address, void *pBuffer, uint8_t Size);
+void EEPROM_MapImage(uint16_t Address, void *pBuffer, uint16_t Size);
+void EEPROM_UnmapImage(void);
+void EEPROM_WriteBlock(uint16_t Address, const void *pBuffer, uint16_t Size, const bool safe);
 void EEPROM_WriteBuffer(uint16_t Address, const void *pBuffer, const bool safe);
+void EEPROM_Flush(void);
+void EEPROM_TimeSlice500ms(void);
 
 #endif
 
@@ -19,7 +19,13 @@
 
 #include <stdint.h>
 #include <stdio.h>     // NULL
+#include <string.h>
 
+#include "ARMCM0.h"
+#ifdef ENABLE_LCD_DMA
+	#include "bsp/dp32g030/dma.h"
+	#include "bsp/dp32g030/irq.h"
+#endif
 #include "bsp/dp32g030/gpio.h"
 #include "bsp/dp32g030/spi.h"
 #include "driver/gpio.h"
@@ -31,16 +37,206 @@
 uint8_t gStatusLine[128];
 uint8_t gFrameBuffer[7][128];
 
+uint32_t gST7565_BytesSent;
+uint32_t gST7565_BytesPerSecond;
+
+// What the LCD RAM currently holds, page 0 is the status line. Blits only
+// send the column spans that differ from it.
+uint8_t gST7565_Shadow[8][128];
+uint8_t gST7565_ShadowValid;   // one bit per page
+
+#ifdef ENABLE_LCD_DMA
+
+// DMA request line of the SPI0 TX FIFO
+#define ST7565_DMA_HSREQ DMA_CH_MOD_MD_SEL_BITS_HSREQ_MS3
+
+volatile bool gST7565_TransferBusy;
+
+// column span of every page still waiting for the DMA
+static uint8_t gST7565_SpanFirst[8];
+static uint8_t gST7565_SpanLast[8];
+static uint8_t gST7565_SpanDirty;     // one bit per page
+
+static void ST7565_BlitLine(const unsigned int Line, const uint8_t *pLine)
+{
+	uint8_t     *pShadow = gST7565_Shadow[Line];
+	unsigned int First   = 0;
+	unsigned int Last    = LCD_WIDTH - 1;
+
+	// with the DMA doing the work one span per page is enough, unchanged
+	// columns in between cost bus time but no CPU time
+	if ((gST7565_ShadowValid >> Line) & 1U)
+	{
+		while (First < LCD_WIDTH && pLine[First] == pShadow[First])
+			First++;
+		if (First == LCD_WIDTH)
+			return;
+		while (pLine[Last] == pShadow[Last])
+			Last--;
+	}
+
+	memcpy(&pShadow[First], &pLine[First], Last + 1 - First);
+
+	gST7565_SpanFirst[Line]  = First;
+	gST7565_SpanLast[Line]   = Last;
+	gST7565_SpanDirty       |= 1U << Line;
+	gST7565_ShadowValid     |= 1U << Line;
+	gST7565_BytesSent       += Last + 1 - First;
+}
+
+// Addresses the next dirty page and hands its span to DMA channel 1, the
+// transfer complete interrupt calls back in here until all pages are sent.
+static void ST7565_NextSpan(void)
+{
+	unsigned int Page = 0;
+	unsigned int First;
+	unsigned int Last;
+
+	while (Page < ARRAY_SIZE(gST7565_SpanFirst) && !((gST7565_SpanDirty >> Page) & 1U))
+		Page++;
+
+	// the last bytes may still be in the FIFO, A0 must not change under them
+	SPI_WaitForUndocumentedTxFifoStatusBit();
+
+	if (Page >= ARRAY_SIZE(gST7565_SpanFirst))
+	{
+		SPI0->CR &= ~SPI_CR_TXDMAEN_MASK;
+		SPI_ToggleMasterMode(&SPI0->CR, true);
+		gST7565_TransferBusy = false;
+		return;
+	}
+
+	First = gST7565_SpanFirst[Page];
+	Last  = gST7565_SpanLast[Page];
+
+	gST7565_SpanDirty &= ~(1U << Page);
+
+	ST7565_SelectColumnAndLine(First + 4U, Page);
+	GPIO_SetBit(&GPIOB->DATA, GPIOB_PIN_ST7565_A0);
+
+	DMA_CH1->MSADDR = (uint32_t)(uintptr_t)&gST7565_Shadow[Page][First];
+	DMA_CH1->MDADDR = (uint32_t)(uintptr_t)&SPI0->WDR;
+	DMA_CH1->MOD    = 0
+		// Source
+		| DMA_CH_MOD_MS_ADDMOD_BITS_INCREMENT
+		| DMA_CH_MOD_MS_SIZE_BITS_8BIT
+		| DMA_CH_MOD_MS_SEL_BITS_SRAM
+		// Destination
+		| DMA_CH_MOD_MD_ADDMOD_BITS_NONE
+		| DMA_CH_MOD_MD_SIZE_BITS_8BIT
+		| ST7565_DMA_HSREQ
+		;
+	DMA_INTEN |= DMA_INTEN_CH1_TC_INTEN_BITS_ENABLE;
+	DMA_CH1->CTR = 0
+		| DMA_CH_CTR_CH_EN_BITS_ENABLE
+		| (((Last - First) << DMA_CH_CTR_LENGTH_SHIFT) & DMA_CH_CTR_LENGTH_MASK)
+		| DMA_CH_CTR_LOOP_BITS_DISABLE
+		| DMA_CH_CTR_PRI_BITS_MEDIUM
+		;
+}
+
+// Kicks off the DMA for the spans collected by ST7565_BlitLine(). The LCD
+// chip select stays asserted until the interrupt has sent the last one.
+static void ST7565_StartTransfer(void)
+{
+	gST7565_TransferBusy = true;
+
+	DMA_CTR   = (DMA_CTR & ~DMA_CTR_DMAEN_MASK) | DMA_CTR_DMAEN_BITS_ENABLE;
+	SPI0->CR |= SPI_CR_TXDMAEN_MASK;
+
+	ST7565_NextSpan();
+}
+
+void ST7565_WaitForTransfer(void)
+{
+	while (gST7565_TransferBusy) {}
+}
+
+void HandlerDMA(void)
+{
+	if (DMA_INTST & DMA_INTST_CH1_TC_INTST_MASK)
+	{
+		DMA_INTST = DMA_INTST_CH1_TC_INTST_BITS_SET;
+		ST7565_NextSpan();
+	}
+}
+
+#else
+
+// unchanged columns worth sending to avoid re-addressing (3 command bytes)
+#define ST7565_SPAN_GAP 3U
+
+static void ST7565_BlitLine(const unsigned int Line, const uint8_t *pLine)
+{
+	uint8_t     *pShadow = gST7565_Shadow[Line];
+	const bool   valid   = (gST7565_ShadowValid >> Line) & 1U;
+	unsigned int Column  = 0;
+
+	while (Column < LCD_WIDTH)
+	{
+		unsigned int Last;
+		unsigned int i;
+
+		if (valid && pLine[Column] == pShadow[Column])
+		{
+			Column++;
+			continue;
+		}
+
+		for (Last = Column, i = Column + 1; i < LCD_WIDTH && i - Last <= ST7565_SPAN_GAP; i++)
+			if (!valid || pLine[i] != pShadow[i])
+				Last = i;
+
+		ST7565_SelectColumnAndLine(Column + 4U, Line);
+		GPIO_SetBit(&GPIOB->DATA, GPIOB_PIN_ST7565_A0);
+		for (i = Column; i <= Last; i++)
+		{
+			while ((SPI0->FIFOST & SPI_FIFOST_TFF_MASK) != SPI_FIFOST_TFF_BITS_NOT_FULL) {}
+			SPI0->WDR = pLine[i];
+			pShadow[i] = pLine[i];
+		}
+		SPI_WaitForUndocumentedTxFifoStatusBit();
+
+		gST7565_BytesSent += Last + 1 - Column;
+		Column = Last + 1;
+	}
+
+	gST7565_ShadowValid |= 1U << Line;
+}
+
+#endif
+
+void ST7565_InvalidateShadow(void)
+{
+	gST7565_ShadowValid = 0;
+}
+
 void ST7565_DrawLine(const unsigned int Column, const unsigned int Line, const unsigned int Size, const uint8_t *pBitmap)
 {
 	unsigned int i;
 
+	ST7565_WaitForTransfer();
+
 	SPI_ToggleMasterMode(&SPI0->CR, false);
 
 	ST7565_SelectColumnAndLine(Column + 4U, Line);
 
 	GPIO_SetBit(&GPIOB->DATA, GPIOB_PIN_ST7565_A0);
 
+	if (Line < ARRAY_SIZE(gST7565_Shadow) && Column + Size <= LCD_WIDTH)
+	{
+		if (pBitmap != NULL)
+			memcpy(&gST7565_Shadow[Line][Column], pBitmap, Size);
+		else
+			memset(&gST7565_Shadow[Line][Column], 0, Size);
+	}
+	else
+	{
+		ST7565_InvalidateShadow();
+	}
+
+	gST7565_BytesSent += Size;
+
 	if (pBitmap != NULL)
 	{
 		for (i = 0; i < Size; i++)
@@ -67,22 +263,14 @@ void ST7565_BlitFullScreen(void)
 {
 	unsigned int Line;
 
+	ST7565_WaitForTransfer();
+
 	SPI_ToggleMasterMode(&SPI0->CR, false);
 
 	ST7565_WriteByte(0x40);
 
 	for (Line = 0; Line < ARRAY_SIZE(gFrameBuffer); Line++)
-	{
-		unsigned int Column;
-		ST7565_SelectColumnAndLine(4, Line + 1);
-		GPIO_SetBit(&GPIOB->DATA, GPIOB_PIN_ST7565_A0);
-		for (Column = 0; Column < ARRAY_SIZE(gFrameBuffer[0]); Column++)
-		{
-			while ((SPI0->FIFOST & SPI_FIFOST_TFF_MASK) != SPI_FIFOST_TFF_BITS_NOT_FULL) {}
-			SPI0->WDR = gFrameBuffer[Line][Column];
-		}
-		SPI_WaitForUndocumentedTxFifoStatusBit();
-	}
+		ST7565_BlitLine(Line + 1, gFrameBuffer[Line]);
 
 	#if 0
 		// whats the delay for I wonder, it holds things up :(
@@ -91,37 +279,41 @@ void ST7565_BlitFullScreen(void)
 //		SYSTEM_DelayMs(1);
 	#endif
 
+#ifdef ENABLE_LCD_DMA
+	ST7565_StartTransfer();
+#else
+	SPI_WaitForUndocumentedTxFifoStatusBit();
+
 	SPI_ToggleMasterMode(&SPI0->CR, true);
+#endif
 }
 
 void ST7565_BlitStatusLine(void)
 {	// the top small text line on the display
 
-	unsigned int i;
+	ST7565_WaitForTransfer();
 
 	SPI_ToggleMasterMode(&SPI0->CR, false);
 
 	ST7565_WriteByte(0x40);    // start line ?
 
-	ST7565_SelectColumnAndLine(4, 0);
-
-	GPIO_SetBit(&GPIOB->DATA, GPIOB_PIN_ST7565_A0);
-
-	for (i = 0; i < ARRAY_SIZE(gStatusLine); i++)
-	{
-		while ((SPI0->FIFOST & SPI_FIFOST_TFF_MASK) != SPI_FIFOST_TFF_BITS_NOT_FULL) {}
-		SPI0->WDR = gStatusLine[i];
-	}
+	ST7565_BlitLine(0, gStatusLine);
 
+#ifdef ENABLE_LCD_DMA
+	ST7565_StartTransfer();
+#else
 	SPI_WaitForUndocumentedTxFifoStatusBit();
 
 	SPI_ToggleMasterMode(&SPI0->CR, true);
+#endif
 }
 
 void ST7565_FillScreen(uint8_t Value)
 {
 	unsigned int i;
 
+	ST7565_WaitForTransfer();
+
 	// reset some of the displays settings to try and overcome the radios hardware problem - RF corrupting the display
 	ST7565_Init(false);
 	
@@ -140,6 +332,11 @@ void ST7565_FillScreen(uint8_t Value)
 		SPI_WaitForUndocumentedTxFifoStatusBit();
 	}
 
+	gST7565_BytesSent += 8 * 132;
+
+	memset(gST7565_Shadow, Value, sizeof(gST7565_Shadow));
+	gST7565_ShadowValid = 0xFF;
+
 	SPI_ToggleMasterMode(&SPI0->CR, true);
 }
 
@@ -210,8 +407,13 @@ uint8_t cmds[] = {
 
 void ST7565_Init(const bool full)
 {
+	ST7565_WaitForTransfer();
+
 	if (full) {
 		SPI0_Init();
+#ifdef ENABLE_LCD_DMA
+		NVIC_EnableIRQ((IRQn_Type)DP32_DMA_IRQn);
+#endif
 		ST7565_HardwareReset();
 		SPI_ToggleMasterMode(&SPI0->CR, false);
 		ST7565_WriteByte(ST7565_CMD_SOFTWARE_RESET);   // software reset
@@ -246,6 +448,10 @@ void ST7565_Init(const bool full)
 
 void ST7565_FixInterfGlitch(void)
 {
+	// the display RAM may be garbled as well, have the next blits rewrite it all
+	ST7565_WaitForTransfer();
+	ST7565_InvalidateShadow();
+
 	SPI_ToggleMasterMode(&SPI0->CR, false);
 	for(uint8_t i = 0; i < ARRAY_SIZE(cmds); i++)
 		ST7565_WriteByte(cmds[i]);
@@ -273,6 +479,22 @@ void ST7565_SelectColumnAndLine(uint8_t Column, uint8_t Line)
 	while ((SPI0->FIFOST & SPI_FIFOST_TFF_MASK) != SPI_FIFOST_TFF_BITS_NOT_FULL) {}
 	SPI0->WDR = ((Column >> 0) & 0x0F);
 	SPI_WaitForUndocumentedTxFifoStatusBit();
+
+	gST7565_BytesSent += 3;
+}
+
+// Every other call latches what gST7565_BytesSent grew by since the last latch
+void ST7565_TimeSlice500ms(void)
+{
+	static uint32_t Mark;
+	static bool     bSecond;
+
+	bSecond = !bSecond;
+	if (!bSecond)
+		return;
+
+	gST7565_BytesPerSecond = gST7565_BytesSent - Mark;
+	Mark                   = gST7565_BytesSent;
 }
 
 void ST7565_WriteByte(uint8_t Value)
@@ -280,4 +502,6 @@ void ST7565_WriteByte(uint8_t Value)
 	GPIO_ClearBit(&GPIOB->DATA, GPIOB_PIN_ST7565_A0);
 	while ((SPI0->FIFOST & SPI_FIFOST_TFF_MASK) != SPI_FIFOST_TFF_BITS_NOT_FULL) {}
 	SPI0->WDR = Value;
+
+	gST7565_BytesSent++;
 }
@@ -29,6 +29,24 @@
 extern uint8_t gStatusLine[128];
 extern uint8_t gFrameBuffer[7][128];
 
+// every byte clocked out to the LCD since boot, commands included
+extern uint32_t gST7565_BytesSent;
+// bytes clocked out during the last full second, latched by ST7565_TimeSlice500ms()
+extern uint32_t gST7565_BytesPerSecond;
+
+// what the LCD RAM holds, page 0 is the status line, and a valid bit per page
+extern uint8_t gST7565_Shadow[8][128];
+extern uint8_t gST7565_ShadowValid;
+
+#ifdef ENABLE_LCD_DMA
+	// a blit is still being clocked out by the DMA
+	extern volatile bool gST7565_TransferBusy;
+
+	void ST7565_WaitForTransfer(void);
+#else
+	static inline void ST7565_WaitForTransfer(void) {}
+#endif
+
 void ST7565_DrawLine(const unsigned int Column, const unsigned int Line, const unsigned int Size, const uint8_t *pBitmap);
 void ST7565_BlitFullScreen(void);
 void ST7565_BlitStatusLine(void);
@@ -36,7 +54,9 @@ void ST7565_FillScreen(uint8_t Value);
 void ST7565_Init(const bool full);
 void ST7565_FixInterfGlitch(void);
 void ST7565_HardwareReset(void);
+void ST7565_InvalidateShadow(void);
 void ST7565_SelectColumnAndLine(uint8_t Column, uint8_t Line);
+void ST7565_TimeSlice500ms(void);
 void ST7565_WriteByte(uint8_t Value);
 
 #endif
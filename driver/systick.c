@@ -26,7 +26,7 @@ static uint32_t gTickMultiplier;
 
 void SYSTICK_Init(void)
 {
-	SysTick_Config(480000);
+	SysTick_Config(SYSTICK_TICK_CYCLES);
 	gTickMultiplier = 48;
 }
 
@@ -46,3 +46,8 @@ void SYSTICK_DelayUs(uint32_t Delay)
 	} while (i < ticks);
 }
 
+// Core clock cycles since the last SysTick
+uint32_t SYSTICK_GetElapsed(void)
+{
+	return SysTick->LOAD - SysTick->VAL;
+}
@@ -22,8 +22,12 @@
 
 #include <stdint.h>
 
-void SYSTICK_Init(void);
-void SYSTICK_DelayUs(uint32_t Delay);
+// 48MHz core clock, one SysTick every 10ms
+#define SYSTICK_TICK_CYCLES 480000U
+
+void     SYSTICK_Init(void);
+void     SYSTICK_DelayUs(uint32_t Delay);
+uint32_t SYSTICK_GetElapsed(void);
 
 #endif
 
@@ -18,7 +18,9 @@
  */
 
 #include <stdbool.h>
+#include "ARMCM0.h"
 #include "bsp/dp32g030/dma.h"
+#include "bsp/dp32g030/irq.h"
 #include "bsp/dp32g030/syscon.h"
 #include "bsp/dp32g030/uart.h"
 #include "driver/uart.h"
@@ -29,13 +31,22 @@
 static bool UART_IsLogEnabled;
 uint8_t UART_DMA_Buffer[256];
 
-void UART_Init(void)
+#ifdef ENABLE_UART_TX_IRQ
+// Bytes waiting for the TX FIFO. UART_Send() only appends and tops up the FIFO
+// itself, HandlerUART1() refills it each time it has drained to the TF level
+// and turns its interrupt off once the ring is empty.
+static uint8_t          UART_TxBuffer[256];
+static volatile uint8_t UART_TxHead;  // written by UART_Send()
+static volatile uint8_t UART_TxTail;  // written by HandlerUART1()
+#endif
+
+// Trimmed RCHF frequency the baud rate divider runs from
+static uint32_t UART_GetClock(void)
 {
 	uint32_t Delta;
 	uint32_t Positive;
 	uint32_t Frequency;
 
-	UART1->CTRL = (UART1->CTRL & ~UART_CTRL_UARTEN_MASK) | UART_CTRL_UARTEN_BITS_DISABLE;
 	Delta = SYSCON_RC_FREQ_DELTA;
 	Positive = (Delta & SYSCON_RC_FREQ_DELTA_RCHF_SIG_MASK) >> SYSCON_RC_FREQ_DELTA_RCHF_SIG_SHIFT;
 	Frequency = (Delta & SYSCON_RC_FREQ_DELTA_RCHF_DELTA_MASK) >> SYSCON_RC_FREQ_DELTA_RCHF_DELTA_SHIFT;
@@ -45,11 +56,19 @@ void UART_Init(void)
 		Frequency = 48000000U - Frequency;
 	}
 
-	UART1->BAUD = Frequency / 39053U;
+	return Frequency;
+}
+
+void UART_Init(void)
+{
+	UART1->CTRL = (UART1->CTRL & ~UART_CTRL_UARTEN_MASK) | UART_CTRL_UARTEN_BITS_DISABLE;
+	UART1->BAUD = UART_GetClock() / UART_BAUD_RATE_DEFAULT;
 	UART1->CTRL = UART_CTRL_RXEN_BITS_ENABLE | UART_CTRL_TXEN_BITS_ENABLE | UART_CTRL_RXDMAEN_BITS_ENABLE;
 	UART1->RXTO = 4;
 	UART1->FC = 0;
-	UART1->FIFO = UART_FIFO_RF_LEVEL_BITS_8_BYTE | UART_FIFO_RF_CLR_BITS_ENABLE | UART_FIFO_TF_CLR_BITS_ENABLE;
+	// TXFIFO is raised once 4 bytes or less are left to send, which leaves the
+	// handler 4 byte times to refill before the line goes idle
+	UART1->FIFO = UART_FIFO_RF_LEVEL_BITS_8_BYTE | UART_FIFO_TF_LEVEL_BITS_4_BYTE | UART_FIFO_RF_CLR_BITS_ENABLE | UART_FIFO_TF_CLR_BITS_ENABLE;
 	UART1->IE = 0;
 
 	DMA_CTR = (DMA_CTR & ~DMA_CTR_DMAEN_MASK) | DMA_CTR_DMAEN_BITS_DISABLE;
@@ -83,13 +102,76 @@ void UART_Init(void)
 		| DMA_CH_CTR_LOOP_BITS_ENABLE
 		| DMA_CH_CTR_PRI_BITS_MEDIUM
 		;
-	UART1->IF = UART_IF_RXTO_BITS_SET;
+	UART1->IF = UART_IF_RXTO_BITS_SET | UART_IF_TXFIFO_BITS_SET;
 
 	DMA_CTR = (DMA_CTR & ~DMA_CTR_DMAEN_MASK) | DMA_CTR_DMAEN_BITS_ENABLE;
 
 	UART1->CTRL |= UART_CTRL_UARTEN_BITS_ENABLE;
+
+#ifdef ENABLE_UART_TX_IRQ
+	UART_TxHead = 0;
+	UART_TxTail = 0;
+	NVIC_EnableIRQ((IRQn_Type)DP32_UART1_IRQn);
+#endif
 }
 
+#ifdef ENABLE_UART_TX_IRQ
+
+// Moves queued bytes into the TX FIFO until either of them runs out. The
+// TXFIFO interrupt stays on for as long as the ring holds more.
+static void UART_FillTxFifo(void)
+{
+	while (UART_TxTail != UART_TxHead && (UART1->IF & UART_IF_TXFIFO_FULL_MASK) == UART_IF_TXFIFO_FULL_BITS_NOT_SET) {
+		UART1->TDR = UART_TxBuffer[UART_TxTail];
+		UART_TxTail++;
+	}
+
+	if (UART_TxTail == UART_TxHead)
+		UART1->IE &= ~UART_IE_TXFIFO_MASK;
+	else
+		UART1->IE |= UART_IE_TXFIFO_BITS_ENABLE;
+}
+
+// Waiting on the ring has to work with interrupts disabled too (commands are
+// handled that way), so the main loop feeds the FIFO itself while it waits.
+static void UART_PollTx(void)
+{
+	NVIC_DisableIRQ((IRQn_Type)DP32_UART1_IRQn);
+	UART_FillTxFifo();
+	NVIC_EnableIRQ((IRQn_Type)DP32_UART1_IRQn);
+}
+
+// Queues the bytes and returns, only waits if the ring is full
+void UART_Send(const void *pBuffer, uint32_t Size)
+{
+	const uint8_t *pData = (const uint8_t *)pBuffer;
+	uint32_t i;
+
+	for (i = 0; i < Size; i++) {
+		const uint8_t Next = UART_TxHead + 1;
+
+		while (Next == UART_TxTail)
+			UART_PollTx();
+
+		UART_TxBuffer[UART_TxHead] = pData[i];
+		UART_TxHead = Next;
+	}
+
+	// An idle FIFO doesn't cross the TF level again, so the first bytes go in
+	// from here and the interrupt takes over when those have drained
+	UART_PollTx();
+}
+
+// TXFIFO is latched when the FIFO drains to the TF level and stays set until
+// written with 1, clear it before refilling so the next drain raises it again
+void HandlerUART1(void)
+{
+	UART1->IF = UART_IF_TXFIFO_BITS_SET;
+	UART_FillTxFifo();
+}
+
+#else
+
 void UART_Send(const void *pBuffer, uint32_t Size)
 {
 	const uint8_t *pData = (const uint8_t *)pBuffer;
@@ -102,6 +184,42 @@ void UART_Send(const void *pBuffer, uint32_t Size)
 	}
 }
 
+#endif
+
+// Bytes UART_Send() can take without waiting. Without the ring it waits on
+// the FIFO for every byte and this only says there is no limit on a send:
+// anything that mustn't wait needs ENABLE_UART_TX_IRQ.
+uint16_t UART_TxFree(void)
+{
+#ifdef ENABLE_UART_TX_IRQ
+	return sizeof(UART_TxBuffer) - 1U - (uint8_t)(UART_TxHead - UART_TxTail);
+#else
+	return UINT16_MAX;
+#endif
+}
+
+// Waits until everything sent so far has left the wire, e.g. before a reset
+void UART_Flush(void)
+{
+#ifdef ENABLE_UART_TX_IRQ
+	while (UART_TxTail != UART_TxHead)
+		UART_PollTx();
+#endif
+	while ((UART1->IF & UART_IF_TXBUSY_MASK) != UART_IF_TXBUSY_BITS_NOT_SET) {
+	}
+}
+
+// Finishes the bytes already queued at the old rate, then switches. The RX DMA
+// keeps running, the peer must not send anything until it has switched too.
+void UART_SetBaudRate(uint32_t BaudRate)
+{
+	UART_Flush();
+
+	UART1->CTRL = (UART1->CTRL & ~UART_CTRL_UARTEN_MASK) | UART_CTRL_UARTEN_BITS_DISABLE;
+	UART1->BAUD = UART_GetClock() / BaudRate;
+	UART1->CTRL |= UART_CTRL_UARTEN_BITS_ENABLE;
+}
+
 void UART_LogSend(const void *pBuffer, uint32_t Size)
 {
 	if (UART_IsLogEnabled) {
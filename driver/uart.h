@@ -23,10 +23,16 @@
 
 #include <stdint.h>
 
+// what the stock firmware programs, the divider comes out close to 38400
+#define UART_BAUD_RATE_DEFAULT 39053U
+
 extern uint8_t UART_DMA_Buffer[256];
 
 void UART_Init(void);
 void UART_Send(const void *pBuffer, uint32_t Size);
+uint16_t UART_TxFree(void);
+void UART_Flush(void);
+void UART_SetBaudRate(uint32_t BaudRate);
 void UART_LogSend(const void *pBuffer, uint32_t Size);
 #ifdef ENABLE_MESSENGER_UART
     void UART_printf(const char *str, ...);
@@ -31,6 +31,7 @@
 	#include "driver/bk1080.h"
 #endif
 #include "driver/bk4819.h"
+#include "driver/eeprom.h"
 #include "driver/gpio.h"
 #include "driver/system.h"
 #include "driver/st7565.h"
@@ -76,15 +77,15 @@ void FUNCTION_Init(void)
 	g_SquelchLost      = false;
 
 	gFlagTailNoteEliminationComplete   = false;
-	gTailNoteEliminationCountdown_10ms = 0;
+	SCHEDULER_TimerCancel(&gTailNoteEliminationTimer);
 	gFoundCTCSS                        = false;
 	gFoundCDCSS                        = false;
-	gFoundCTCSSCountdown_10ms          = 0;
-	gFoundCDCSSCountdown_10ms          = 0;
+	SCHEDULER_TimerCancel(&gFoundCTCSSTimer);
+	SCHEDULER_TimerCancel(&gFoundCDCSSTimer);
 	gEndOfRxDetectedMaybe              = false;
 
 	#ifdef ENABLE_NOAA
-		gNOAACountdown_10ms = 0;
+		SCHEDULER_TimerCancel(&gNOAAIncomingTimer);
 	#endif
 
 	gUpdateStatus = true;
@@ -134,6 +135,8 @@ void FUNCTION_Select(FUNCTION_Type_t Function)
 				gDTMF_auto_reset_time_500ms = gEeprom.DTMF_auto_reset_time * 2;
 			}
 #endif
+			// back from RX/TX skips the arm at the end
+			SCHEDULER_TimerArm(&gBatterySaveTimer, battery_save_count_10ms);
 			gUpdateStatus = true;
 			return;
 
@@ -146,13 +149,16 @@ void FUNCTION_Select(FUNCTION_Type_t Function)
 			break;
 
 		case FUNCTION_POWER_SAVE:
-			gPowerSave_10ms            = gEeprom.BATTERY_SAVE * 10;
+			SCHEDULER_TimerArm(&gPowerSaveTimer, gEeprom.BATTERY_SAVE * 10);
 			gPowerSaveCountdownExpired = false;
 
 			gRxIdleMode = true;
 
 			gMonitor = false;
 
+			// likely to be switched off from here
+			EEPROM_Flush();
+
 			BK4819_DisableVox();			
 			BK4819_Sleep();
 
@@ -166,6 +172,8 @@ void FUNCTION_Select(FUNCTION_Type_t Function)
 			return;
 
 		case FUNCTION_TRANSMIT:
+			EEPROM_Flush();
+
 			#ifdef ENABLE_MESSENGER
 				MSG_EnableRX(false);	
 			#endif	
@@ -263,7 +271,7 @@ void FUNCTION_Select(FUNCTION_Type_t Function)
 			break;
 	}
 
-	gBatterySaveCountdown_10ms = battery_save_count_10ms;
+	SCHEDULER_TimerArm(&gBatterySaveTimer, battery_save_count_10ms);
 	gSchedulePowerSave         = false;
 
 	#if defined(ENABLE_FMRADIO)
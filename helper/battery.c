@@ -47,7 +47,7 @@ typedef enum {
 uint16_t          lowBatteryCountdown;
 const uint16_t 	  lowBatteryPeriod = 30;
 
-volatile uint16_t gPowerSave_10ms;
+SCHEDULER_Timer_t gPowerSaveTimer;
 
 
 unsigned int BATTERY_VoltsToPercent(const unsigned int voltage_10mV)
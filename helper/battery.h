@@ -23,6 +23,8 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#include "scheduler.h"
+
 extern uint16_t          gBatteryCalibration[6];
 extern uint16_t          gBatteryCurrentVoltage;
 extern uint16_t          gBatteryVoltages[4];
@@ -33,7 +35,7 @@ extern bool              gLowBattery;
 extern bool              gLowBatteryConfirmed;
 extern uint16_t          gBatteryCheckCounter;
 
-extern volatile uint16_t gPowerSave_10ms;
+extern SCHEDULER_Timer_t gPowerSaveTimer;
 
 typedef enum {
     BATTERY_TYPE_1600_MAH,
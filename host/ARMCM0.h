@@ -0,0 +1,66 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#ifndef HOST_ARMCM0_H
+#define HOST_ARMCM0_H
+
+// The subset of the CMSIS core API used by the firmware, mapped onto the
+// simulator. The NVIC only keeps the enable bits, SysTick is driven by the
+// host clock.
+
+#include <stdint.h>
+
+#include "sim/hw.h"
+
+typedef int IRQn_Type;
+
+static inline void NVIC_EnableIRQ(IRQn_Type IRQn)  { HOST_NvicEnable(IRQn, true); }
+static inline void NVIC_DisableIRQ(IRQn_Type IRQn) { HOST_NvicEnable(IRQn, false); }
+
+static inline void NVIC_SystemReset(void)
+{
+	HOST_Reset();
+}
+
+static inline uint32_t SysTick_Config(uint32_t ticks)
+{
+	(void)ticks;
+	HOST_ClockInit();
+	return 0;
+}
+
+#define __disable_irq() HOST_DisableIrq()
+#define __enable_irq()  HOST_EnableIrq()
+#define __WFI()         HOST_WaitForInterrupt()
+
+static inline uint32_t __get_PRIMASK(void)
+{
+	return HOST_IrqDisabled();
+}
+
+static inline void __set_PRIMASK(uint32_t Primask)
+{
+	if (Primask)
+		HOST_DisableIrq();
+	else
+		HOST_EnableIrq();
+}
+
+#define __DSB()         __sync_synchronize()
+#define __ISB()         __sync_synchronize()
+#define __NOP()         do {} while (0)
+
+#endif
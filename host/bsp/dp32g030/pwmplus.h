@@ -0,0 +1,27 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#ifndef HOST_DP32G030_PWMPLUS_H
+#define HOST_DP32G030_PWMPLUS_H
+
+// Real register map, re-based onto the simulated peripheral window
+#include <dp32g030/pwmplus.h>
+#include "sim/hw.h"
+
+#undef  PWM_PLUS0_BASE_ADDR
+#define PWM_PLUS0_BASE_ADDR HOST_Peripheral(0x400B4000U)
+
+#endif
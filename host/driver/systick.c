@@ -0,0 +1,37 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#include "ARMCM0.h"
+#include "driver/systick.h"
+#include "sim/hw.h"
+
+void SYSTICK_Init(void)
+{
+	SysTick_Config(SYSTICK_TICK_CYCLES);
+}
+
+// Busy waits cost nothing on the host, the time is added to the MCU clock
+// instead so timeouts and the 10ms tick still see it elapse.
+void SYSTICK_DelayUs(uint32_t Delay)
+{
+	HOST_SkipTimeUs(Delay);
+}
+
+// SysTick fires on every 10ms boundary of the MCU clock
+uint32_t SYSTICK_GetElapsed(void)
+{
+	return (uint32_t)(HOST_GetTimeUs() % 10000U) * (SYSTICK_TICK_CYCLES / 10000U);
+}
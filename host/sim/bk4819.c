@@ -0,0 +1,518 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "driver/bk4819.h"
+#include "driver/bk4819-regs.h"
+#include "sim/hw.h"
+
+// BK4819 register file on the 3-wire bus (SCN, SCL, SDA).
+// A frame is 8 address bits (bit 7 set for a read) followed by 16 data bits,
+// all sampled on the rising SCL edge. On a read the chip shifts its data out
+// on the falling edges that follow the address byte.
+//
+// Only what the firmware polls is modelled: the receiver status registers
+// return a noise floor with a little jitter, plus an optional carrier, and
+// REG_63 reports 0xFF (not settled) for a short while after every retune.
+// How long is set with -s, separately for the VHF and UHF front ends, and a
+// retune to a lower frequency than the last one counts as a new spectrum sweep.
+//
+// With -b every completed frame is logged as "W rr vvvv" or "R rr vvvv", which
+// makes it easy to check that two builds put the same traffic on the bus.
+//
+// After every frame the register shadow of the driver is held against the
+// register file: a cached value that differs, or a cached status register
+// the chip changes by itself, counts as stale. -v fails the run on those.
+//
+// With -r every write frame is kept, together with whether SCL stayed low
+// since the frame before it, which is what BK4819_WriteRegisters() does
+// between the entries of a table. On exit a table covering every register is
+// sent and has to come out as written, then each frame of it and of every
+// table the firmware wrote is sent again through BK4819_WriteRegister() and
+// has to match bit for bit.
+//
+// With -i the chip opens and closes its squelch every MS milliseconds or so,
+// some of the edges chattering for a few ms and each followed by a burst of
+// whatever tone interrupts REG_3F enables. Raised bits stay pending until the
+// firmware writes REG_02, which latches them for the read that follows and
+// drops the request flag in REG_0C. A bit raised again before that merges
+// with the pending one and is lost, as on the real chip; the stats count
+// those and time every bit from raise to acknowledge, and every settled
+// squelch edge to the audio path following it.
+
+#define UHF_FROM        28000000U  // where the firmware switches to the UHF LNA
+#define CARRIER_SPAN    2500U    // 25kHz in 10Hz units
+#define CARRIER_LEVEL   120U     // 60dB over the noise floor
+#define CHATTER_US      1500U    // gap between the edges of a chattering squelch
+#define TONE_BITS       (BK4819_REG_02_CTCSS_FOUND | BK4819_REG_02_CTCSS_LOST | \
+                         BK4819_REG_02_CDCSS_FOUND | BK4819_REG_02_CDCSS_LOST)
+
+typedef struct {
+	uint32_t Bits;      // SDA on every rising SCL edge, the first one highest
+	uint8_t  Count;     // rising SCL edges
+	bool     bBatched;  // SCL stayed low since the frame before
+} Frame_t;
+
+static uint16_t gRegisters[128];
+
+static bool     gScn = true;
+static bool     gScl = true;
+static uint8_t  gBits;
+static uint8_t  gAddress;
+static uint16_t gData;
+static uint32_t gRaw;
+static uint16_t gReadValue;
+static bool     gOut = true;
+static bool     gSclRose = true;  // since SCN last went high
+static bool     gBatched;        // no SCL pulse before the current frame
+
+static Frame_t *gFrames;         // -r
+static size_t   gFrameCount;
+static size_t   gFrameSize;
+static bool     gReplaying;
+static Frame_t  gReplayed[128];
+static size_t   gReplayedCount;
+
+static uint64_t gSettledAt;
+static uint32_t gSeed = 0x4B5A;
+static FILE    *gTrace;
+
+static uint16_t gPending;        // raised, not yet acknowledged
+static uint16_t gLatched;        // REG_02 readback since the last acknowledge
+static uint64_t gRaisedAt[16];
+static uint64_t gMaskChangedAt;  // last write to REG_3F or REG_30
+static uint64_t gEdgeAt;         // next squelch edge
+static unsigned gChatter;        // edges left in the current burst
+static bool     gSquelchOpen;
+static bool     gSquelchChanged; // not reported yet
+static bool     gAudioOn;
+static uint64_t gWaitingSince;   // settled squelch edge the audio path has yet to follow
+
+static uint16_t Jitter(unsigned int Amplitude)
+{
+	gSeed = gSeed * 1103515245u + 12345u;
+	return (gSeed >> 16) % (2 * Amplitude + 1);
+}
+
+static uint32_t Frequency(void)
+{
+	return gRegisters[BK4819_REG_38] | (uint32_t)gRegisters[BK4819_REG_39] << 16;
+}
+
+static void Retune(uint32_t NewFrequency)
+{
+	const uint64_t Now = HOST_GetTimeUs();
+
+	if (NewFrequency >= Frequency())
+		return;
+
+	if (gHostStats.Sweeps++ == 0)
+		gHostStats.FirstSweepUs = Now;
+	gHostStats.LastSweepUs = Now;
+}
+
+static uint16_t Rssi(void)
+{
+	const uint32_t Tuned = Frequency();
+	uint16_t       Value = gHostOptions.NoiseFloor - 3 + Jitter(3);
+
+	if (gHostOptions.CarrierFrequency) {
+		const uint32_t Delta = Tuned > gHostOptions.CarrierFrequency
+			? Tuned - gHostOptions.CarrierFrequency
+			: gHostOptions.CarrierFrequency - Tuned;
+
+		if (Delta < CARRIER_SPAN)
+			Value += CARRIER_LEVEL - CARRIER_LEVEL * Delta / CARRIER_SPAN;
+	}
+
+	return Value & 0x01FF;
+}
+
+static void Raise(uint16_t Bits, uint64_t At)
+{
+	unsigned int Bit;
+
+	Bits &= gRegisters[BK4819_REG_3F];
+
+	for (Bit = 0; Bit < 16; Bit++) {
+		if (!(Bits & (1U << Bit)))
+			continue;
+
+		gHostStats.BK4819_IrqRaised++;
+		if (gPending & (1U << Bit))
+			gHostStats.BK4819_IrqMerged++;
+		else
+			gRaisedAt[Bit] = At;
+		gPending |= 1U << Bit;
+	}
+}
+
+// Raises the interrupt for the current squelch state unless that has been
+// done already. A receiver that is off or has the interrupt masked finds out
+// once it is back, so a change in between is reported from then on.
+static void ReportSquelch(uint64_t At)
+{
+	const uint16_t Bit = gSquelchOpen ? BK4819_REG_02_SQUELCH_LOST : BK4819_REG_02_SQUELCH_FOUND;
+
+	if (!gSquelchChanged || !gRegisters[BK4819_REG_30] || !(gRegisters[BK4819_REG_3F] & Bit))
+		return;
+	if (At < gMaskChangedAt)
+		At = gMaskChangedAt;
+
+	gSquelchChanged = false;
+	Raise(Bit, At);
+}
+
+static void Squelch(uint64_t At, bool bSettled)
+{
+	gSquelchOpen    = !gSquelchOpen;
+	gSquelchChanged = true;
+
+	if (bSettled) {
+		// the audio path should follow this one, and should have followed the last one
+		if (gWaitingSince)
+			gHostStats.AudioMissed++;
+		gWaitingSince = (gAudioOn != gSquelchOpen) ? At : 0;
+	}
+
+	ReportSquelch(At);
+}
+
+static void GenerateInterrupts(void)
+{
+	const uint64_t Now    = HOST_GetTimeUs();
+	const uint32_t Period = gHostOptions.InterruptPeriodMs * 1000U;
+
+	if (Period == 0)
+		return;
+
+	// nothing polls the chip while the firmware is still booting
+	if (!HOST_MainLoopRunning()) {
+		gEdgeAt = Now + Period / 2;
+		return;
+	}
+
+	ReportSquelch(0);
+
+	while (gEdgeAt <= Now) {
+		// a fading signal may close and reopen the squelch a couple of times
+		// before it closes for good
+		if (gChatter == 0 && gSquelchOpen && Jitter(1) == 0)
+			gChatter = 2 + 2 * Jitter(1);
+
+		if (gChatter) {
+			gChatter--;
+			Squelch(gEdgeAt, false);
+			gEdgeAt += CHATTER_US;
+			continue;
+		}
+
+		Squelch(gEdgeAt, true);
+		Raise(TONE_BITS & Jitter(0x7FFF), gEdgeAt + Jitter(750));
+		gEdgeAt += Period / 2 + Jitter(Period / 4) * 2;
+	}
+}
+
+static void Acknowledge(void)
+{
+	const uint64_t Now = HOST_GetTimeUs();
+	unsigned int   Bit;
+
+	for (Bit = 0; Bit < 16; Bit++) {
+		uint64_t Wait;
+
+		if (!(gPending & (1U << Bit)))
+			continue;
+
+		Wait = Now - gRaisedAt[Bit];
+		gHostStats.BK4819_IrqAcked++;
+		gHostStats.BK4819_IrqWaitUs += Wait;
+		if (Wait > gHostStats.BK4819_IrqWaitMaxUs)
+			gHostStats.BK4819_IrqWaitMaxUs = Wait;
+	}
+
+	gLatched = gPending;
+	gPending = 0;
+}
+
+void HOST_BK4819_AudioPath(bool On)
+{
+	gAudioOn = On;
+
+	if (gWaitingSince && On == gSquelchOpen) {
+		const uint64_t Wait = HOST_GetTimeUs() - gWaitingSince;
+
+		gHostStats.AudioFollowed++;
+		gHostStats.AudioWaitUs += Wait;
+		if (Wait > gHostStats.AudioWaitMaxUs)
+			gHostStats.AudioWaitMaxUs = Wait;
+		gWaitingSince = 0;
+	}
+}
+
+static uint16_t ReadRegister(uint8_t Register)
+{
+	gHostStats.BK4819_Reads++;
+
+	switch (Register) {
+	case BK4819_REG_67:
+		if (HOST_GetTimeUs() < gSettledAt)
+			gHostStats.EarlyRssiReads++;
+		return Rssi();
+	case BK4819_REG_63:
+		return HOST_GetTimeUs() < gSettledAt ? 0xFF : Jitter(2);
+	case BK4819_REG_65:
+		return 0x0040 | Jitter(4);
+	case BK4819_REG_0C:
+		GenerateInterrupts();
+		return gPending != 0;
+	case BK4819_REG_02:
+		return gLatched;
+	default:
+		return gRegisters[Register];
+	}
+}
+
+static void Trace(char Direction, uint8_t Register, uint16_t Value)
+{
+	if (gTrace != NULL)
+		fprintf(gTrace, "%c %02X %04X\n", Direction, Register, Value);
+}
+
+static void WriteRegister(uint8_t Register, uint16_t Value)
+{
+	bool bRetuned = false;
+
+	gHostStats.BK4819_Writes++;
+
+	switch (Register) {
+	case BK4819_REG_3F:
+	case BK4819_REG_30:
+		// whatever came up under the old mask has been raised by now
+		GenerateInterrupts();
+		gMaskChangedAt = HOST_GetTimeUs();
+		if (Register == BK4819_REG_3F)
+			break;
+		// fall through
+	case BK4819_REG_38:
+	case BK4819_REG_39:
+		if (Register == BK4819_REG_39)
+			Retune(gRegisters[BK4819_REG_38] | (uint32_t)Value << 16);
+		bRetuned = true;
+		break;
+	case BK4819_REG_02:
+		GenerateInterrupts();
+		Acknowledge();
+		Value = 0;
+		break;
+	default:
+		break;
+	}
+
+	Trace('W', Register, Value);
+
+	gRegisters[Register] = Value;
+
+	if (bRetuned)
+		gSettledAt = HOST_GetTimeUs() + gHostOptions.SettleUs[Frequency() >= UHF_FROM];
+}
+
+void HOST_BK4819_Init(void)
+{
+	memset(gRegisters, 0, sizeof(gRegisters));
+	if (gHostOptions.NoiseFloor == 0)
+		gHostOptions.NoiseFloor = 80;
+	if (gHostOptions.SettleUs[0] == 0)
+		gHostOptions.SettleUs[0] = 300;
+	if (gHostOptions.SettleUs[1] == 0)
+		gHostOptions.SettleUs[1] = gHostOptions.SettleUs[0];
+
+	if (gHostOptions.BusTracePath != NULL) {
+		gTrace = fopen(gHostOptions.BusTracePath, "w");
+		if (gTrace == NULL) {
+			perror(gHostOptions.BusTracePath);
+			exit(1);
+		}
+	}
+}
+
+// Registers ReadRegister() makes up rather than returning what was written
+static bool ChangesByItself(uint8_t Register)
+{
+	return Register == BK4819_REG_02 || Register == BK4819_REG_0C ||
+	       Register == BK4819_REG_63 || Register == BK4819_REG_65 || Register == BK4819_REG_67;
+}
+
+static void CheckShadow(void)
+{
+	unsigned int Register;
+	uint16_t     Value;
+
+	for (Register = 0; Register < 128; Register++) {
+		if (!BK4819_ShadowPeek((BK4819_REGISTER_t)Register, &Value))
+			continue;
+		if (!ChangesByItself(Register) && Value == gRegisters[Register])
+			continue;
+		if (gHostStats.BK4819_ShadowStale++ == 0)
+			fprintf(stderr, "bk4819 shadow of REG_%02X holds %04X, the chip %04X\n",
+				Register, Value, gRegisters[Register]);
+	}
+}
+
+static void Record(void)
+{
+	const Frame_t Frame = { gRaw, gBits, gBatched };
+
+	if (gReplaying) {
+		if (gReplayedCount < 128)
+			gReplayed[gReplayedCount] = Frame;
+		gReplayedCount++;
+		return;
+	}
+
+	if (gFrameCount == gFrameSize) {
+		gFrameSize = gFrameSize ? gFrameSize * 2 : 4096;
+		gFrames    = realloc(gFrames, gFrameSize * sizeof(*gFrames));
+		if (gFrames == NULL) {
+			perror("realloc");
+			exit(1);
+		}
+	}
+	gFrames[gFrameCount++] = Frame;
+}
+
+// Sends one register on its own and compares it with a frame of a table
+static bool SameAsSingle(const Frame_t *pFrame, unsigned long Index)
+{
+	gReplayedCount = 0;
+	BK4819_WriteRegister((pFrame->Bits >> 16) & 0x7F, pFrame->Bits & 0xFFFF);
+
+	if (gReplayedCount == 1 && gReplayed[0].Count == pFrame->Count && gReplayed[0].Bits == pFrame->Bits)
+		return true;
+
+	fprintf(stderr, "bk4819 frame %lu differs: %u bits %06lX in a table, %u bits %06lX on its own\n",
+		Index, pFrame->Count, (unsigned long)pFrame->Bits,
+		gReplayed[0].Count, (unsigned long)gReplayed[0].Bits);
+	return false;
+}
+
+int HOST_BK4819_Check(void)
+{
+	static const uint16_t Patterns[] = { 0x0000, 0xFFFF, 0xAAAA, 0x5555 };
+	BK4819_RegWrite_t     Table[128];
+	unsigned long         Batches = 0;
+	unsigned long         Frames  = 0;
+	size_t                i;
+
+	// the run may have stopped halfway through a frame, an empty table ends
+	// it and leaves SCL high like any write
+	gReplaying = true;
+	BK4819_WriteRegisters(NULL, 0);
+
+	// the firmware's tables are only seen on the bus, so first one with
+	// known values: every register, the bit patterns and some noise
+	for (i = 0; i < 128; i++)
+		Table[i] = (BK4819_RegWrite_t){ i, (i < 4) ? Patterns[i] : (uint16_t)(Jitter(0x7FFF) * 2 + (i & 1)) };
+
+	gReplayedCount = 0;
+	BK4819_WriteRegisters(Table, 128);
+	if (gReplayedCount != 128) {
+		fprintf(stderr, "bk4819 table of 128 sent as %lu frames\n", (unsigned long)gReplayedCount);
+		return 1;
+	}
+	for (i = 0; i < 128; i++) {
+		const Frame_t Frame = gReplayed[i];
+
+		if (Frame.Count != 24 || Frame.Bits != (i << 16 | Table[i].Value) || Frame.bBatched != (i > 0)) {
+			fprintf(stderr, "bk4819 table entry %lu sent as %u bits %06lX, not %06lX\n",
+				(unsigned long)i, Frame.Count, (unsigned long)Frame.Bits, (unsigned long)(i << 16 | Table[i].Value));
+			return 1;
+		}
+		if (!SameAsSingle(&Frame, i))
+			return 1;
+	}
+
+	// then whatever the firmware wrote as tables during the run
+	for (i = 0; i < gFrameCount; i++) {
+		const Frame_t *pFrame = &gFrames[i];
+
+		if (!pFrame->bBatched && (i + 1 == gFrameCount || !gFrames[i + 1].bBatched))
+			continue;
+
+		Batches += !pFrame->bBatched;
+		Frames++;
+
+		if (!SameAsSingle(pFrame, i))
+			return 1;
+	}
+
+	gReplaying = false;
+
+	if (Batches == 0) {
+		fprintf(stderr, "bk4819 tables     none written\n");
+		return 1;
+	}
+
+	fprintf(stderr, "bk4819 tables     %lu written, %lu frames, all same as single writes\n", Batches, Frames);
+	return 0;
+}
+
+bool HOST_BK4819_Update(bool Scn, bool Scl, bool Sda)
+{
+	if (Scn != gScn) {
+		if (!Scn) {
+			gBits    = 0;
+			gAddress = 0;
+			gData    = 0;
+			gRaw     = 0;
+			gBatched = !gSclRose;
+		} else {
+			if (gBits >= 8 && !(gAddress & 0x80) && (gReplaying || gHostOptions.BusCheck))
+				Record();
+			if (!gReplaying && gBits >= 8) {
+				if (!(gAddress & 0x80) && gBits == 24)
+					WriteRegister(gAddress & 0x7F, gData);
+				else if (gAddress & 0x80)
+					Trace('R', gAddress & 0x7F, gReadValue);
+				CheckShadow();
+			}
+			gSclRose = false;
+		}
+		gOut = true;
+	} else if (Scn && Scl && !gScl) {
+		gSclRose = true;
+	} else if (!Scn && Scl && !gScl) {
+		if (gBits < 8)
+			gAddress = (uint8_t)(gAddress << 1) | Sda;
+		else
+			gData = (uint16_t)(gData << 1) | Sda;
+		gRaw = gRaw << 1 | Sda;
+		gBits++;
+	} else if (!Scn && !Scl && gScl && (gAddress & 0x80) && gBits >= 8 && gBits < 24) {
+		if (gBits == 8)
+			gReadValue = ReadRegister(gAddress & 0x7F);
+		gOut = (gReadValue >> (15 - (gBits - 8))) & 1U;
+	}
+
+	gScn = Scn;
+	gScl = Scl;
+
+	return gOut;
+}
@@ -0,0 +1,290 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#include <signal.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+
+#include <dp32g030/irq.h>
+
+#include "driver/st7565.h"
+#include "sim/hw.h"
+
+// MCU time is wall clock time since boot plus every busy wait that was
+// skipped. The SysTick interrupt fires on each 10ms boundary of that clock,
+// either from a 1ms host timer or from the next delay, whichever comes first.
+
+#define TICK_US 10000U
+
+// The host timer and the WFI loop look at the clock every 1ms or less, a
+// longer gap means the host didn't run the simulator. That time is left out,
+// it would show as late slices and overslept WFIs.
+#define STALL_US 5000U
+
+void SystickHandler(void);
+extern volatile bool gNextTimeslice;
+extern volatile bool gNextTimeslice_500ms;
+void HandlerDMA(void) __attribute__((weak));
+void HandlerUART1(void) __attribute__((weak));
+
+static uint64_t              gBootNs;
+static volatile uint64_t     gSkippedUs;
+static uint64_t              gLastRawUs;     // wall clock at the last look
+static uint64_t              gStalledUs;     // the host didn't run us
+static volatile uint64_t     gNextTickUs;
+static volatile sig_atomic_t gIrqDisabled;
+static volatile sig_atomic_t gInHandler;
+static volatile uint32_t     gNvicEnabled;
+static bool                  gRunning;
+static volatile uint32_t     gInterrupts;    // handlers run so far
+static uint64_t              gSliceDueUs;    // tick that set gNextTimeslice, 0 once done
+static bool                  gMainLoop;      // boot is over, the main loop runs the slices
+static uint64_t              gPausedUs;      // wall clock at HOST_ClockPause()
+
+static uint64_t MonotonicNs(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void OnAlarm(int Signal)
+{
+	(void)Signal;
+	HOST_ServiceInterrupts();
+}
+
+static void StartTimer(void)
+{
+	struct itimerval timer;
+
+	timer.it_interval.tv_sec  = 0;
+	timer.it_interval.tv_usec = 1000;
+	timer.it_value            = timer.it_interval;
+	setitimer(ITIMER_REAL, &timer, NULL);
+
+	gRunning = true;
+}
+
+void HOST_ClockInit(void)
+{
+	struct sigaction sa;
+
+	if (gRunning)
+		return;
+
+	gBootNs     = MonotonicNs();
+	gSkippedUs  = 0;
+	gLastRawUs  = 0;
+	gStalledUs  = 0;
+	gNextTickUs = TICK_US;
+
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = OnAlarm;
+	sa.sa_flags   = SA_RESTART;
+	sigemptyset(&sa.sa_mask);
+	sigaction(SIGALRM, &sa, NULL);
+
+	StartTimer();
+}
+
+// The interval timer survives execv(), stop it before a reset or the new
+// image takes a SIGALRM before it has installed its handler.
+void HOST_ClockStop(void)
+{
+	struct itimerval timer;
+
+	memset(&timer, 0, sizeof(timer));
+	setitimer(ITIMER_REAL, &timer, NULL);
+
+	gRunning = false;
+}
+
+// The time until HOST_ClockResume() is left out of MCU time, the simulator
+// is busy with something of its own (a power cut replay)
+void HOST_ClockPause(void)
+{
+	HOST_ClockStop();
+	gPausedUs = (MonotonicNs() - gBootNs) / 1000u;
+}
+
+void HOST_ClockResume(void)
+{
+	const uint64_t Raw = (MonotonicNs() - gBootNs) / 1000u;
+
+	__atomic_add_fetch(&gStalledUs, Raw - gPausedUs, __ATOMIC_RELAXED);
+	__atomic_store_n(&gLastRawUs, Raw, __ATOMIC_RELAXED);
+	StartTimer();
+}
+
+uint64_t HOST_GetTimeUs(void)
+{
+	// stalled first: when the host timer counts a stall in between, we return
+	// a time from before it, never one from after it less the stall
+	uint64_t       Stalled = __atomic_load_n(&gStalledUs, __ATOMIC_RELAXED);
+	const uint64_t Raw     = (MonotonicNs() - gBootNs) / 1000u;
+	uint64_t       Last    = __atomic_load_n(&gLastRawUs, __ATOMIC_RELAXED);
+
+	if (Raw > Last && __atomic_compare_exchange_n(&gLastRawUs, &Last, Raw, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED)
+		&& Raw > Last + STALL_US)
+		Stalled = __atomic_add_fetch(&gStalledUs, Raw - Last - STALL_US, __ATOMIC_RELAXED);
+
+	return Raw + gSkippedUs - Stalled;
+}
+
+void HOST_SkipTimeUs(uint32_t Delay)
+{
+	gSkippedUs += Delay;
+	gHostStats.DelayUs += Delay;
+	HOST_Peripheral(HOST_PERIPH_BASE);
+	HOST_ServiceInterrupts();
+}
+
+// The main loop has until the next tick to run a time slice, one still
+// pending when the tick comes round again was late. Ticks during boot are
+// left pending on purpose and don't count.
+static void CheckSlices(uint64_t Now)
+{
+	if (gSliceDueUs && !gNextTimeslice) {
+		if (gMainLoop && Now - gSliceDueUs > gHostStats.SliceLatencyMaxUs)
+			gHostStats.SliceLatencyMaxUs = Now - gSliceDueUs;
+		gSliceDueUs = 0;
+		gMainLoop   = true;
+	}
+}
+
+bool HOST_MainLoopRunning(void)
+{
+	return gMainLoop;
+}
+
+void HOST_ServiceInterrupts(void)
+{
+	uint64_t Now;
+
+	if (!gRunning || gIrqDisabled || gInHandler || HOST_InPeripheral())
+		return;
+
+	gInHandler = 1;
+
+	Now = HOST_GetTimeUs();
+	CheckSlices(Now);
+	while (gNextTickUs <= Now) {
+		if (gMainLoop && gNextTimeslice)
+			gHostStats.LateSlices++;
+		if (gMainLoop && gNextTimeslice_500ms && gHostStats.Ticks % 50 == 49)
+			gHostStats.LateSlices500ms++;
+		if (!gSliceDueUs)
+			gSliceDueUs = gNextTickUs;
+		gNextTickUs += TICK_US;
+		gHostStats.Ticks++;
+		gInterrupts++;
+		SystickHandler();
+	}
+
+	if (gST7565_BytesPerSecond > gHostStats.LCD_SecondMax)
+		gHostStats.LCD_SecondMax = gST7565_BytesPerSecond;
+
+	// a masked DMA interrupt stays pending until it is enabled
+	HOST_DMA_Update();
+	if ((gNvicEnabled & (1U << DP32_DMA_IRQn)) && HOST_DMA_TakeIrq() && HandlerDMA != NULL) {
+		gInterrupts++;
+		HandlerDMA();
+	}
+
+	HOST_Peripheral(HOST_PERIPH_BASE);
+	if ((gNvicEnabled & (1U << DP32_UART1_IRQn)) && HOST_UART_TakeIrq() && HandlerUART1 != NULL) {
+		gInterrupts++;
+		HandlerUART1();
+	}
+
+	HOST_POWERCUT_Sample();
+
+	if (gHostOptions.RunTimeMs && Now >= (uint64_t)gHostOptions.RunTimeMs * 1000u)
+		HOST_Exit(0);
+
+	gInHandler = 0;
+}
+
+bool HOST_InInterrupt(void)
+{
+	return gInHandler;
+}
+
+static bool InterruptPending(void)
+{
+	return gNextTickUs <= HOST_GetTimeUs()
+		|| ((gNvicEnabled & (1U << DP32_DMA_IRQn)) && HOST_DMA_IrqPending())
+		|| ((gNvicEnabled & (1U << DP32_UART1_IRQn)) && HOST_UART_TakeIrq());
+}
+
+// Like the core, wakes on any enabled interrupt. With interrupts masked it
+// returns as soon as one is pending and the handler runs once they are
+// enabled again, otherwise the host timer takes it while we sleep.
+void HOST_WaitForInterrupt(void)
+{
+	const uint64_t Start      = HOST_GetTimeUs();
+	const uint32_t Interrupts = gInterrupts;
+
+	CheckSlices(Start);
+
+	// the slice would wait for whatever interrupt comes next
+	if (gMainLoop && (gNextTimeslice || gNextTimeslice_500ms))
+		gHostStats.SleptPending++;
+
+	while (gInterrupts == Interrupts) {
+		struct timespec ts = { 0, 200000 };
+
+		// nothing touches the registers while asleep, keep the models going
+		HOST_Peripheral(HOST_PERIPH_BASE);
+		HOST_DMA_Update();
+		HOST_UART_Poll();
+
+		if (gIrqDisabled && InterruptPending())
+			break;
+
+		nanosleep(&ts, NULL);
+		HOST_ServiceInterrupts();
+	}
+
+	gHostStats.IdleUs += HOST_GetTimeUs() - Start;
+}
+
+void HOST_NvicEnable(int IRQn, bool bEnable)
+{
+	if (bEnable)
+		gNvicEnabled |= 1U << IRQn;
+	else
+		gNvicEnabled &= ~(1U << IRQn);
+}
+
+void HOST_DisableIrq(void)
+{
+	gIrqDisabled = 1;
+}
+
+bool HOST_IrqDisabled(void)
+{
+	return gIrqDisabled;
+}
+
+void HOST_EnableIrq(void)
+{
+	gIrqDisabled = 0;
+	HOST_ServiceInterrupts();
+}
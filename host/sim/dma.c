@@ -0,0 +1,140 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#include <stddef.h>
+
+#include <dp32g030/dma.h>
+#include <dp32g030/gpio.h>
+#include <dp32g030/spi.h>
+
+#include "driver/gpio.h"
+#include "sim/hw.h"
+
+// DMA channels that feed SPI0->WDR. A transfer starts when the firmware sets
+// CH_EN and then moves one byte per microsecond of MCU time, roughly the SPI0
+// byte rate, so it stays in flight while the firmware carries on. Each byte
+// goes to the LCD with whatever A0 is at that moment, so a driver that
+// touches A0 or WDR before the transfer is complete garbles the display and
+// bumps SPI_DmaConflicts.
+//
+// The ST7565 driver clears TXDMAEN once it has sent the last span of a blit,
+// which is when its shadow has to match the display RAM.
+//
+// CH_EN drops and the TC status bit is set when a transfer completes, the
+// status bit is cleared again when the channel is restarted (write one to
+// clear is not modelled). The UART1 RX channel is not handled here either,
+// sim/uart.c fills its buffer.
+
+#define CHANNELS 4
+
+#define CH_REG(Ch, Field) (*HOST_Register(DMA_CH0_BASE_ADDR + (Ch) * 0x20U + offsetof(DMA_Channel_t, Field)))
+
+typedef struct {
+	bool     Active;
+	uint64_t StartUs;
+	uint32_t Source;
+	uint32_t Length;
+	uint32_t Sent;
+} Transfer_t;
+
+static Transfer_t gTransfers[CHANNELS];
+static bool       gIrqPending;
+static bool       gTxDmaEnabled;
+
+static bool IsSpiTransfer(unsigned int Channel)
+{
+	const uint32_t Mod = CH_REG(Channel, MOD);
+
+	// the firmware sees the register file at its host address
+	return CH_REG(Channel, MDADDR) == (uint32_t)(uintptr_t)HOST_Register(SPI0_BASE_ADDR + offsetof(SPI_Port_t, WDR))
+		&& (Mod & DMA_CH_MOD_MD_SEL_MASK) != DMA_CH_MOD_MD_SEL_BITS_SRAM
+		&& (*HOST_Register(SPI0_BASE_ADDR + offsetof(SPI_Port_t, CR)) & SPI_CR_TXDMAEN_MASK);
+}
+
+void HOST_DMA_Update(void)
+{
+	const uint64_t Now = HOST_GetTimeUs();
+	const bool     TxDmaEnabled = *HOST_Register(SPI0_BASE_ADDR + offsetof(SPI_Port_t, CR)) & SPI_CR_TXDMAEN_MASK;
+
+	if (gTxDmaEnabled && !TxDmaEnabled)
+		HOST_ST7565_Check();
+	gTxDmaEnabled = TxDmaEnabled;
+
+	if (!(*HOST_Register(DMA_CTR_ADDR) & DMA_CTR_DMAEN_MASK))
+		return;
+
+	for (unsigned int Channel = 0; Channel < CHANNELS; Channel++) {
+		Transfer_t *pTransfer = &gTransfers[Channel];
+		const uint32_t Ctr    = CH_REG(Channel, CTR);
+		uint64_t Due;
+
+		if (!pTransfer->Active) {
+			if (!(Ctr & DMA_CH_CTR_CH_EN_MASK) || !IsSpiTransfer(Channel))
+				continue;
+			pTransfer->Active  = true;
+			pTransfer->StartUs = Now;
+			pTransfer->Source  = CH_REG(Channel, MSADDR);
+			pTransfer->Length  = ((Ctr & DMA_CH_CTR_LENGTH_MASK) >> DMA_CH_CTR_LENGTH_SHIFT) + 1;
+			pTransfer->Sent    = 0;
+			*HOST_Register(DMA_INTST_ADDR) &= ~(1U << (DMA_INTST_CH0_TC_INTST_SHIFT + Channel));
+		}
+
+		Due = Now - pTransfer->StartUs;
+		if (Due > pTransfer->Length)
+			Due = pTransfer->Length;
+
+		while (pTransfer->Sent < Due) {
+			const bool    Data  = GPIO_CheckBit(HOST_Register(GPIOB_BASE_ADDR + offsetof(GPIO_Bank_t, DATA)), GPIOB_PIN_ST7565_A0);
+			const uint8_t Value = *(const uint8_t *)(uintptr_t)(pTransfer->Source + pTransfer->Sent);
+
+			if (!Data)
+				gHostStats.SPI_DmaConflicts++;
+			HOST_ST7565_Write(Value, Data);
+			gHostStats.SPI_DmaBytes++;
+			pTransfer->Sent++;
+		}
+
+		if (pTransfer->Sent == pTransfer->Length) {
+			pTransfer->Active = false;
+			CH_REG(Channel, CTR) &= ~DMA_CH_CTR_CH_EN_MASK;
+			*HOST_Register(DMA_INTST_ADDR) |= 1U << (DMA_INTST_CH0_TC_INTST_SHIFT + Channel);
+			if (*HOST_Register(DMA_INTEN_ADDR) & (1U << (DMA_INTEN_CH0_TC_INTEN_SHIFT + Channel)))
+				gIrqPending = true;
+		}
+	}
+}
+
+bool HOST_DMA_SpiBusy(void)
+{
+	for (unsigned int Channel = 0; Channel < CHANNELS; Channel++)
+		if (gTransfers[Channel].Active)
+			return true;
+
+	return false;
+}
+
+bool HOST_DMA_IrqPending(void)
+{
+	return gIrqPending;
+}
+
+bool HOST_DMA_TakeIrq(void)
+{
+	const bool Pending = gIrqPending;
+
+	gIrqPending = false;
+	return Pending;
+}
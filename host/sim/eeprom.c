@@ -0,0 +1,272 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "sim/hw.h"
+
+// 24C64 serial EEPROM on the bit-banged I2C bus: 8KB, 32 byte pages,
+// 5ms self timed write cycle during which the chip does not acknowledge.
+// Contents are kept in a file so settings survive a restart. With -p the
+// power fails after that many bytes reached the cells, in the middle of a
+// page write if it comes to that, or each cut in a range is replayed (see
+// powercut.c) while the run goes on.
+
+#define EEPROM_SIZE       0x2000U
+#define EEPROM_PAGE_SIZE  32U
+#define EEPROM_WRITE_US   5000U
+#define EEPROM_DEVICE     0xA0U
+
+typedef enum {
+	I2C_IDLE,
+	I2C_RECEIVE,      // clocking a byte in from the master
+	I2C_ACK_SEND,     // we pull SDA low for the acknowledge clock
+	I2C_TRANSMIT,     // clocking a byte out to the master
+	I2C_ACK_RECEIVE,  // master acknowledges the byte we sent
+} I2C_State_t;
+
+static uint8_t     gMemory[EEPROM_SIZE];
+static int         gFd = -1;
+
+static I2C_State_t gState;
+static bool        gScl = true;
+static bool        gSda = true;
+static bool        gOut = true;
+static uint8_t     gBit;
+static uint8_t     gShift;
+static uint8_t     gByteIndex;     // bytes received since START
+static bool        gSelected;
+static bool        gReading;
+static bool        gNack;
+static uint16_t    gAddress;
+static uint8_t     gPage[EEPROM_PAGE_SIZE];
+static uint8_t     gPageLength;
+static uint64_t    gBusyUntil;
+
+static void Seed(void)
+{
+	// factory battery calibration, without it the radio boots into power save
+	static const uint16_t Battery[6] = { 1900, 1960, 2020, 2080, 2140, 2300 };
+
+	memset(gMemory, 0xFF, sizeof(gMemory));
+	memcpy(gMemory + 0x1F40, Battery, sizeof(Battery));
+}
+
+void HOST_EEPROM_Init(const char *pPath)
+{
+	Seed();
+
+	if (pPath == NULL)
+		return;
+
+	gFd = open(pPath, O_RDWR | O_CREAT, 0644);
+	if (gFd < 0) {
+		perror(pPath);
+		exit(1);
+	}
+
+	if (read(gFd, gMemory, sizeof(gMemory)) != (ssize_t)sizeof(gMemory)) {
+		Seed();
+		if (pwrite(gFd, gMemory, sizeof(gMemory), 0) != (ssize_t)sizeof(gMemory))
+			perror(pPath);
+	}
+}
+
+uint8_t HOST_EEPROM_Peek(uint16_t Address)
+{
+	return gMemory[Address % EEPROM_SIZE];
+}
+
+// No transfer going on and no write cycle either, a read would go through
+bool HOST_EEPROM_Idle(void)
+{
+	return gState == I2C_IDLE && gScl && gSda && HOST_GetTimeUs() >= gBusyUntil;
+}
+
+void HOST_EEPROM_Save(const char *pPath)
+{
+	const int Fd = open(pPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+	if (Fd < 0 || write(Fd, gMemory, sizeof(gMemory)) != (ssize_t)sizeof(gMemory)) {
+		perror(pPath);
+		exit(1);
+	}
+	close(Fd);
+}
+
+static void CommitPage(void)
+{
+	const uint16_t Base = gAddress & ~(EEPROM_PAGE_SIZE - 1);
+	uint16_t       Offset = gAddress & (EEPROM_PAGE_SIZE - 1);
+
+	bool           PowerCut = false;
+
+	// the address counter rolls over within the page, just like the real part
+	for (unsigned int i = 0; i < gPageLength; i++) {
+		HOST_POWERCUT_Replay(gHostStats.EEPROM_WriteBytes);
+		if (gHostOptions.PowerCut && gHostStats.EEPROM_WriteBytes == gHostOptions.PowerCut) {
+			// the rest of the page keeps its old contents
+			PowerCut = true;
+			break;
+		}
+		gMemory[Base + Offset] = gPage[i];
+		Offset = (Offset + 1) % EEPROM_PAGE_SIZE;
+		gHostStats.EEPROM_WriteBytes++;
+	}
+
+	if (gFd >= 0 && pwrite(gFd, gMemory + Base, EEPROM_PAGE_SIZE, Base) != EEPROM_PAGE_SIZE)
+		perror("eeprom");
+
+	if (PowerCut) {
+		if (!gHostOptions.Quiet)
+			fprintf(stderr, "power cut\n");
+		HOST_Exit(0);
+	}
+
+	gBusyUntil = HOST_GetTimeUs() + EEPROM_WRITE_US;
+	gHostStats.EEPROM_WriteCycles++;
+}
+
+// Returns false if the byte is not acknowledged
+static bool ByteReceived(uint8_t Value)
+{
+	gHostStats.I2C_Bytes++;
+
+	if (gByteIndex++ == 0) {
+		if ((Value & 0xFE) != EEPROM_DEVICE)
+			return false;
+		if (HOST_GetTimeUs() < gBusyUntil) {
+			gHostStats.EEPROM_BusyNacks++;
+			return false;
+		}
+		gSelected = true;
+		gReading  = Value & 1U;
+		return true;
+	}
+
+	if (!gSelected)
+		return false;
+
+	switch (gByteIndex) {
+	case 2:
+		gAddress = (uint16_t)(Value << 8) % EEPROM_SIZE;
+		break;
+	case 3:
+		gAddress = (gAddress & 0xFF00) | Value;
+		gPageLength = 0;
+		break;
+	default:
+		if (gPageLength < EEPROM_PAGE_SIZE)
+			gPage[gPageLength++] = Value;
+		break;
+	}
+
+	return true;
+}
+
+bool HOST_EEPROM_Update(bool Scl, bool Sda)
+{
+	if (Scl && gScl && Sda != gSda) {
+		if (!Sda) {
+			// START, also a repeated one
+			gHostStats.I2C_Starts++;
+			gState     = I2C_RECEIVE;
+			gBit       = 0;
+			gShift     = 0;
+			gByteIndex = 0;
+			gSelected  = false;
+			gOut       = true;
+		} else {
+			// STOP
+			if (gSelected && !gReading && gPageLength)
+				CommitPage();
+			gState      = I2C_IDLE;
+			gSelected   = false;
+			gPageLength = 0;
+			gOut        = true;
+		}
+	} else if (Scl && !gScl) {
+		// rising edge, the receiver samples
+		if (gState == I2C_RECEIVE) {
+			gShift = (uint8_t)(gShift << 1) | Sda;
+			gBit++;
+		} else if (gState == I2C_ACK_RECEIVE) {
+			gNack = Sda;
+		}
+	} else if (!Scl && gScl) {
+		// falling edge, the transmitter changes SDA
+		switch (gState) {
+		case I2C_RECEIVE:
+			if (gBit == 8) {
+				if (ByteReceived(gShift)) {
+					gState = I2C_ACK_SEND;
+					gOut   = false;
+				} else {
+					gState = I2C_IDLE;
+					gOut   = true;
+				}
+			}
+			break;
+
+		case I2C_ACK_SEND:
+			gBit   = 0;
+			gShift = 0;
+			if (gReading) {
+				gState = I2C_TRANSMIT;
+				gShift = gMemory[gAddress];
+				gOut   = gShift & 0x80;
+			} else {
+				gState = I2C_RECEIVE;
+				gOut   = true;
+			}
+			break;
+
+		case I2C_TRANSMIT:
+			if (++gBit < 8) {
+				gOut = (gShift << gBit) & 0x80;
+			} else {
+				gHostStats.I2C_Bytes++;
+				gAddress = (gAddress + 1) % EEPROM_SIZE;
+				gState   = I2C_ACK_RECEIVE;
+				gOut     = true;
+			}
+			break;
+
+		case I2C_ACK_RECEIVE:
+			if (gNack) {
+				gState = I2C_IDLE;
+			} else {
+				gState = I2C_TRANSMIT;
+				gBit   = 0;
+				gShift = gMemory[gAddress];
+				gOut   = gShift & 0x80;
+			}
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	gScl = Scl;
+	gSda = Sda;
+
+	return gOut;
+}
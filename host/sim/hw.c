@@ -0,0 +1,384 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// the real register maps, not the re-based wrappers
+#include <dp32g030/crc.h>
+#include <dp32g030/dma.h>
+#include <dp32g030/gpio.h>
+#include <dp32g030/saradc.h>
+#include <dp32g030/spi.h>
+#include <dp32g030/uart.h>
+
+#include "driver/bk4819.h"
+#include "driver/gpio.h"
+#include "driver/st7565.h"
+#include "scheduler.h"
+#include "sim/hw.h"
+
+// Every register macro of the firmware goes through HOST_Peripheral() before
+// the access is made. That call is used as the bus clock: it first lets the
+// device models consume whatever the previous access did (a byte written to
+// SPI0->WDR, a GPIO edge on the BK4819 or I2C lines, ...) and then refreshes
+// the input pins, so the access that follows sees an up to date register file.
+
+#define REG(Address) gRegisters[((Address) - HOST_PERIPH_BASE) / 4]
+
+#define GPIO_DATA(Base) REG((Base) + offsetof(GPIO_Bank_t, DATA))
+#define GPIO_DIR(Base)  REG((Base) + offsetof(GPIO_Bank_t, DIR))
+
+#define SPI0_WDR        REG(SPI0_BASE_ADDR + offsetof(SPI_Port_t, WDR))
+#define UART1_TDR       REG(UART1_BASE_ADDR + offsetof(UART_Port_t, TDR))
+#define ADC_STAT(Ch)    REG(SARADC_CH0_ADDR + (Ch) * sizeof(ADC_Channel_t) + offsetof(ADC_Channel_t, STAT))
+#define ADC_DATA(Ch)    REG(SARADC_CH0_ADDR + (Ch) * sizeof(ADC_Channel_t) + offsetof(ADC_Channel_t, DATA))
+
+#define KEYBOARD_COLUMNS ( \
+	1U << GPIOA_PIN_KEYBOARD_0 | \
+	1U << GPIOA_PIN_KEYBOARD_1 | \
+	1U << GPIOA_PIN_KEYBOARD_2 | \
+	1U << GPIOA_PIN_KEYBOARD_3)
+
+HOST_Stats_t   gHostStats;
+HOST_Options_t gHostOptions;
+char         **gHostArgv;
+
+static volatile uint32_t gRegisters[HOST_PERIPH_SIZE / 4];
+
+static volatile bool gInSync;
+static uint32_t gCrc;
+static uint32_t gCrcControl;
+static uint32_t gI2cLines   = ~0U;
+static uint32_t gBk4819Lines = ~0U;
+static bool     gI2cSda     = true;
+static bool     gBk4819Sda  = true;
+static bool     gAudioPath;
+static uint16_t gBatteryAdc;
+
+static void FlushWrites(void)
+{
+	if (SPI0_WDR != HOST_REG_IDLE) {
+		if (HOST_DMA_SpiBusy())
+			gHostStats.SPI_DmaConflicts++;
+		HOST_ST7565_Write(SPI0_WDR, GPIO_CheckBit(&GPIO_DATA(GPIOB_BASE_ADDR), GPIOB_PIN_ST7565_A0));
+		SPI0_WDR = HOST_REG_IDLE;
+	}
+
+	if (UART1_TDR != HOST_REG_IDLE) {
+		HOST_UART_Transmit(UART1_TDR);
+		UART1_TDR = HOST_REG_IDLE;
+	}
+
+	// CRC-16/XMODEM, restarted from IV whenever the block gets enabled
+	if ((REG(CRC_CR_ADDR) & CRC_CR_CRC_EN_MASK) && !(gCrcControl & CRC_CR_CRC_EN_MASK))
+		gCrc = REG(CRC_IV_ADDR) & 0xFFFF;
+	gCrcControl = REG(CRC_CR_ADDR);
+
+	if (REG(CRC_DATAIN_ADDR) != HOST_REG_IDLE) {
+		gCrc ^= (REG(CRC_DATAIN_ADDR) & 0xFF) << 8;
+		for (unsigned int i = 0; i < 8; i++)
+			gCrc = (gCrc & 0x8000) ? (gCrc << 1) ^ 0x1021 : gCrc << 1;
+		gCrc &= 0xFFFF;
+		REG(CRC_DATAIN_ADDR)  = HOST_REG_IDLE;
+		REG(CRC_DATAOUT_ADDR) = gCrc;
+	}
+}
+
+static void UpdateBuses(void)
+{
+	const uint32_t DataA = GPIO_DATA(GPIOA_BASE_ADDR);
+	const uint32_t DirA  = GPIO_DIR(GPIOA_BASE_ADDR);
+	const uint32_t DataC = GPIO_DATA(GPIOC_BASE_ADDR);
+	const uint32_t DirC  = GPIO_DIR(GPIOC_BASE_ADDR);
+	uint32_t       Lines;
+
+	// pins switched to input are released, the pull-up holds them high
+	Lines = (DataA | ~DirA) & (1U << GPIOA_PIN_I2C_SCL | 1U << GPIOA_PIN_I2C_SDA);
+	if (Lines != gI2cLines) {
+		const bool Sda = (Lines >> GPIOA_PIN_I2C_SDA) & 1U;
+
+		gI2cLines = Lines;
+		gI2cSda   = HOST_EEPROM_Update((Lines >> GPIOA_PIN_I2C_SCL) & 1U, Sda) && Sda;
+	}
+
+	Lines  = DataC & (1U << GPIOC_PIN_BK4819_SCN | 1U << GPIOC_PIN_BK4819_SCL);
+	Lines |= (DataC | ~DirC) & (1U << GPIOC_PIN_BK4819_SDA);
+	if (Lines != gBk4819Lines) {
+		gBk4819Lines = Lines;
+		gBk4819Sda   = HOST_BK4819_Update(
+			(Lines >> GPIOC_PIN_BK4819_SCN) & 1U,
+			(Lines >> GPIOC_PIN_BK4819_SCL) & 1U,
+			(Lines >> GPIOC_PIN_BK4819_SDA) & 1U);
+	}
+
+	if (((DataC >> GPIOC_PIN_AUDIO_PATH) & 1U) != gAudioPath) {
+		gAudioPath = !gAudioPath;
+		HOST_BK4819_AudioPath(gAudioPath);
+	}
+}
+
+static void UpdateInputs(void)
+{
+	uint32_t Data;
+
+	Data  = GPIO_DATA(GPIOA_BASE_ADDR) | KEYBOARD_COLUMNS;
+	Data &= ~HOST_KEYS_Columns(Data);
+	if (!(GPIO_DIR(GPIOA_BASE_ADDR) & GPIO_DIR_11_MASK)) {
+		Data &= ~(1U << GPIOA_PIN_I2C_SDA);
+		Data |= (uint32_t)gI2cSda << GPIOA_PIN_I2C_SDA;
+	}
+	GPIO_DATA(GPIOA_BASE_ADDR) = Data;
+
+	Data  = GPIO_DATA(GPIOC_BASE_ADDR) & ~(1U << GPIOC_PIN_PTT);
+	Data |= (uint32_t)!HOST_KEYS_Ptt() << GPIOC_PIN_PTT;
+	if (!(GPIO_DIR(GPIOC_BASE_ADDR) & GPIO_DIR_2_MASK)) {
+		Data &= ~(1U << GPIOC_PIN_BK4819_SDA);
+		Data |= (uint32_t)gBk4819Sda << GPIOC_PIN_BK4819_SDA;
+	}
+	GPIO_DATA(GPIOC_BASE_ADDR) = Data;
+
+	// conversions complete instantly, CH4 is the battery divider
+	ADC_STAT(9) = ADC_CHx_STAT_EOC_BITS_COMPLETE;
+	ADC_STAT(4) = ADC_CHx_STAT_EOC_BITS_COMPLETE;
+	ADC_DATA(4) = gBatteryAdc;
+	ADC_DATA(9) = 0;
+}
+
+uintptr_t HOST_Peripheral(uint32_t Address)
+{
+	gHostStats.RegisterAccesses++;
+
+	if (!gInSync) {
+		gInSync = true;
+		FlushWrites();
+		HOST_UART_Update();
+		HOST_UART_Access(Address == UART1_BASE_ADDR && !HOST_InInterrupt());
+		HOST_DMA_Update();
+		UpdateBuses();
+		UpdateInputs();
+		if ((gHostStats.RegisterAccesses & 0x3FF) == 0)
+			HOST_UART_Poll();
+		gInSync = false;
+	}
+
+	return (uintptr_t)gRegisters + (Address - HOST_PERIPH_BASE);
+}
+
+// The peripheral models aren't reentrant, an interrupt taken halfway through
+// an update would see them half done (and lose TDR writes)
+bool HOST_InPeripheral(void)
+{
+	return gInSync;
+}
+
+volatile uint32_t *HOST_Register(uint32_t Address)
+{
+	return &REG(Address);
+}
+
+void HOST_Init(void)
+{
+	uint16_t Calibration;
+
+	memset((void *)gRegisters, 0, sizeof(gRegisters));
+	SPI0_WDR             = HOST_REG_IDLE;
+	UART1_TDR            = HOST_REG_IDLE;
+	REG(CRC_DATAIN_ADDR) = HOST_REG_IDLE;
+
+	HOST_EEPROM_Init(gHostOptions.EepromPath);
+	HOST_BK4819_Init();
+	HOST_UART_Init();
+	HOST_KEYS_Init(gHostOptions.Keys);
+
+	// a fully charged pack, ~7.8V through the calibration the firmware will load
+	Calibration = HOST_EEPROM_Peek(0x1F46) | HOST_EEPROM_Peek(0x1F47) << 8;
+	if (Calibration == 0 || Calibration == 0xFFFF)
+		Calibration = 2080;
+	gBatteryAdc = (uint32_t)Calibration * 780 / 760;
+	if (gBatteryAdc > 0xFFF)
+		gBatteryAdc = 0xFFF;
+}
+
+static void PrintStats(void)
+{
+	const uint64_t Ms   = HOST_GetTimeUs() / 1000u;
+	const uint64_t Duty = Ms ? 1000u - gHostStats.IdleUs / Ms : 1000u;
+
+	fprintf(stderr,
+		"mcu time          %llu.%03llu s\n"
+		"systick           %llu\n"
+		"register access   %llu\n"
+		"delay skipped     %llu us\n"
+		"wfi idle          %llu us (duty %llu.%llu%%)\n"
+		"late slices       %llu 10ms / %llu 500ms (max wait %llu us, slept pending %llu)\n"
+		"bk4819 rd/wr      %llu / %llu\n"
+		"bk4819 shadow     %lu hits / %lu misses (stale %llu)\n"
+		"first frame       %llu.%03llu ms (%llu i2c starts)\n"
+		"i2c starts/bytes  %llu / %llu\n"
+		"eeprom writes     %llu, %llu bytes (busy nacks %llu)\n"
+		"spi cmd/data      %llu / %llu\n"
+		"spi dma           %llu (conflicts %llu)\n"
+		"lcd bytes         %lu (%llu/s, busiest second %lu, %llu per redraw, stale %llu, miscounted %llu)\n"
+		"uart tx/rx        %llu / %llu\n"
+		"uart tx wait      %llu us (overruns %llu)\n"
+		"uart framing err  %llu\n",
+		(unsigned long long)(Ms / 1000u),
+		(unsigned long long)(Ms % 1000u),
+		(unsigned long long)gHostStats.Ticks,
+		(unsigned long long)gHostStats.RegisterAccesses,
+		(unsigned long long)gHostStats.DelayUs,
+		(unsigned long long)gHostStats.IdleUs,
+		(unsigned long long)(Duty / 10u),
+		(unsigned long long)(Duty % 10u),
+		(unsigned long long)gHostStats.LateSlices,
+		(unsigned long long)gHostStats.LateSlices500ms,
+		(unsigned long long)gHostStats.SliceLatencyMaxUs,
+		(unsigned long long)gHostStats.SleptPending,
+		(unsigned long long)gHostStats.BK4819_Reads,
+		(unsigned long long)gHostStats.BK4819_Writes,
+		(unsigned long)gBK4819_ShadowHits,
+		(unsigned long)gBK4819_ShadowMisses,
+		(unsigned long long)gHostStats.BK4819_ShadowStale,
+		(unsigned long long)(gHostStats.FirstFrameUs / 1000u),
+		(unsigned long long)(gHostStats.FirstFrameUs % 1000u),
+		(unsigned long long)gHostStats.FirstFrameI2C,
+		(unsigned long long)gHostStats.I2C_Starts,
+		(unsigned long long)gHostStats.I2C_Bytes,
+		(unsigned long long)gHostStats.EEPROM_WriteCycles,
+		(unsigned long long)gHostStats.EEPROM_WriteBytes,
+		(unsigned long long)gHostStats.EEPROM_BusyNacks,
+		(unsigned long long)gHostStats.SPI_CommandBytes,
+		(unsigned long long)gHostStats.SPI_DataBytes,
+		(unsigned long long)gHostStats.SPI_DmaBytes,
+		(unsigned long long)gHostStats.SPI_DmaConflicts,
+		(unsigned long)gST7565_BytesSent,
+		(unsigned long long)(Ms ? gST7565_BytesSent * 1000ull / Ms : 0),
+		(unsigned long)gHostStats.LCD_SecondMax,
+		(unsigned long long)(gHostStats.LCD_Redraws ? gST7565_BytesSent / gHostStats.LCD_Redraws : 0),
+		(unsigned long long)gHostStats.LCD_Stale,
+		(unsigned long long)gHostStats.LCD_Miscounted,
+		(unsigned long long)gHostStats.UART_TxBytes,
+		(unsigned long long)gHostStats.UART_RxBytes,
+		(unsigned long long)gHostStats.UART_TxWaitUs,
+		(unsigned long long)gHostStats.UART_TxOverruns,
+		(unsigned long long)gHostStats.UART_FramingErrors);
+
+	if (gHostStats.Sweeps > 1) {
+		const uint64_t Us = gHostStats.LastSweepUs - gHostStats.FirstSweepUs;
+
+		fprintf(stderr, "spectrum sweeps   %llu (%llu.%02llu/s), %llu rssi reads before settling\n",
+			(unsigned long long)gHostStats.Sweeps,
+			(unsigned long long)((gHostStats.Sweeps - 1) * 1000000ull / Us),
+			(unsigned long long)((gHostStats.Sweeps - 1) * 100000000ull / Us % 100),
+			(unsigned long long)gHostStats.EarlyRssiReads);
+	}
+
+	if (gHostOptions.InterruptPeriodMs) {
+		const uint64_t Acked    = gHostStats.BK4819_IrqAcked;
+		const uint64_t Followed = gHostStats.AudioFollowed;
+
+		fprintf(stderr,
+			"bk4819 irq        %llu raised, %llu merged, %llu acked (wait avg %llu max %llu us)\n"
+			"squelch to audio  %llu followed, %llu missed (wait avg %llu max %llu us)\n",
+			(unsigned long long)gHostStats.BK4819_IrqRaised,
+			(unsigned long long)gHostStats.BK4819_IrqMerged,
+			(unsigned long long)Acked,
+			(unsigned long long)(Acked ? gHostStats.BK4819_IrqWaitUs / Acked : 0),
+			(unsigned long long)gHostStats.BK4819_IrqWaitMaxUs,
+			(unsigned long long)Followed,
+			(unsigned long long)gHostStats.AudioMissed,
+			(unsigned long long)(Followed ? gHostStats.AudioWaitUs / Followed : 0),
+			(unsigned long long)gHostStats.AudioWaitMaxUs);
+	}
+
+#ifdef ENABLE_WFI_IDLE
+	// the firmware's own figure, for the last 500ms only
+	fprintf(stderr, "firmware duty     %u.%u%%\n",
+		SCHEDULER_GetDutyCycle() / 10u, SCHEDULER_GetDutyCycle() % 10u);
+#endif
+}
+
+// -v: the run fails on what the statistics can only show
+static int Verify(void)
+{
+	const uint64_t Ms     = HOST_GetTimeUs() / 1000u;
+	const uint64_t Rate   = Ms ? gST7565_BytesSent * 1000ull / Ms : 0;
+	int            Status = 0;
+
+	if (gHostStats.BK4819_ShadowStale || gBK4819_ShadowHits == 0) {
+		fprintf(stderr, "verify: bk4819 shadow %lu hits, %llu stale\n",
+			(unsigned long)gBK4819_ShadowHits, (unsigned long long)gHostStats.BK4819_ShadowStale);
+		Status = 1;
+	}
+
+	if (gHostStats.LCD_Stale || gHostStats.LCD_Miscounted) {
+		fprintf(stderr, "verify: lcd %llu stale pages, bytes miscounted %llu times\n",
+			(unsigned long long)gHostStats.LCD_Stale, (unsigned long long)gHostStats.LCD_Miscounted);
+		Status = 1;
+	}
+
+	if (gHostStats.SleptPending) {
+		fprintf(stderr, "verify: slept %llu times with a slice pending\n",
+			(unsigned long long)gHostStats.SleptPending);
+		Status = 1;
+	}
+
+	if (gHostOptions.LcdBudget && (Rate > gHostOptions.LcdBudget || gHostStats.LCD_SecondMax > gHostOptions.LcdBudget)) {
+		fprintf(stderr, "verify: lcd %llu bytes/s, busiest second %lu, over the %lu allowed\n",
+			(unsigned long long)Rate, (unsigned long)gHostStats.LCD_SecondMax,
+			(unsigned long)gHostOptions.LcdBudget);
+		Status = 1;
+	}
+
+	return Status;
+}
+
+void HOST_Exit(int Status)
+{
+	HOST_DisableIrq();
+	FlushWrites();
+	HOST_ST7565_Dump();
+	// the run may have stopped in a BK4819 read, take SDA back like its end
+	GPIO_DIR(GPIOC_BASE_ADDR) = (GPIO_DIR(GPIOC_BASE_ADDR) & ~GPIO_DIR_2_MASK) | GPIO_DIR_2_BITS_OUTPUT;
+	if (gHostOptions.BusCheck && HOST_BK4819_Check())
+		Status = 1;
+	if (HOST_POWERCUT_Check())
+		Status = 1;
+	if (gHostOptions.Verify && Verify())
+		Status = 1;
+	if (!gHostOptions.Quiet)
+		PrintStats();
+	exit(Status);
+}
+
+void HOST_Reset(void)
+{
+	HOST_DisableIrq();
+	FlushWrites();
+	HOST_ClockStop();
+	if (!gHostOptions.Quiet) {
+		fprintf(stderr, "system reset\n");
+		PrintStats();
+	}
+	fflush(NULL);
+	execv("/proc/self/exe", gHostArgv);
+	perror("execv");
+	exit(1);
+}
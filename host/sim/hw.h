@@ -0,0 +1,160 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#ifndef HOST_SIM_HW_H
+#define HOST_SIM_HW_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Peripheral window of the dp32g030 that is backed by host memory
+#define HOST_PERIPH_BASE 0x40000000U
+#define HOST_PERIPH_SIZE 0x000C0000U
+
+// Written to data registers with write side effects (SPI WDR, UART TDR,
+// CRC DATAIN) so a flush can tell a pending write from an already consumed one
+#define HOST_REG_IDLE    0xFFFFFFFFU
+
+typedef struct {
+	uint64_t Ticks;             // 10ms SysTick interrupts delivered
+	uint64_t RegisterAccesses;  // peripheral register accesses
+	uint64_t DelayUs;           // time skipped by SYSTICK_DelayUs
+	uint64_t IdleUs;            // time spent in __WFI
+	uint64_t LateSlices;        // 10ms slices still pending at the next tick
+	uint64_t LateSlices500ms;   // 500ms slices still pending 500ms later
+	uint64_t SleptPending;      // __WFI entered with a slice pending
+	uint64_t SliceLatencyMaxUs; // longest wait from a tick to its 10ms slice done
+	uint64_t BK4819_Reads;
+	uint64_t BK4819_Writes;
+	uint64_t BK4819_ShadowStale;  // cached registers that differed from the chip, per frame
+	uint64_t BK4819_IrqRaised;    // interrupt bits raised by -i
+	uint64_t BK4819_IrqMerged;    // raised again while still pending
+	uint64_t BK4819_IrqAcked;     // latched by a REG_02 write
+	uint64_t BK4819_IrqWaitUs;    // raise to acknowledge, summed
+	uint64_t BK4819_IrqWaitMaxUs;
+	uint64_t AudioFollowed;       // settled squelch edges the audio path followed
+	uint64_t AudioMissed;         // ... and the ones it did not follow before the next
+	uint64_t AudioWaitUs;
+	uint64_t AudioWaitMaxUs;
+	uint64_t Sweeps;              // retunes to a lower frequency
+	uint64_t FirstSweepUs;
+	uint64_t LastSweepUs;
+	uint64_t EarlyRssiReads;      // REG_67 read while REG_63 still said 0xFF
+	uint64_t I2C_Starts;
+	uint64_t I2C_Bytes;
+	uint64_t EEPROM_WriteCycles;
+	uint64_t EEPROM_WriteBytes;
+	uint64_t EEPROM_BusyNacks;
+	uint64_t SPI_CommandBytes;
+	uint64_t SPI_DataBytes;
+	uint64_t SPI_DmaBytes;
+	uint64_t SPI_DmaConflicts;  // SPI0 or A0 touched while a DMA transfer was running
+	uint64_t LCD_Redraws;       // blits and inits, each starts with "start line 0"
+	uint64_t LCD_Stale;         // shadow pages that differed from the LCD RAM once all was sent
+	uint64_t LCD_Miscounted;    // ... and times gST7565_BytesSent was off
+	uint32_t LCD_SecondMax;     // highest gST7565_BytesPerSecond the firmware latched
+	uint64_t FirstFrameUs;      // first lit pixel on the LCD
+	uint64_t FirstFrameI2C;     // I2C starts up to then
+	uint64_t UART_TxBytes;
+	uint64_t UART_RxBytes;
+	uint64_t UART_TxWaitUs;     // main loop polling a full TX FIFO
+	uint64_t UART_TxOverruns;   // TDR written while the TX FIFO was full
+	uint64_t UART_FramingErrors;  // bytes lost to a baud rate mismatch
+} HOST_Stats_t;
+
+typedef struct {
+	const char *EepromPath;
+	const char *LcdPath;
+	const char *BusTracePath;       // BK4819 frame log
+	const char *Keys;
+	uint32_t    RunTimeMs;
+	uint32_t    CarrierFrequency;   // in 10Hz units, 0 = none
+	uint16_t    NoiseFloor;         // raw BK4819 RSSI units
+	uint16_t    SettleUs[2];        // REG_63 busy after a retune, VHF and UHF
+	uint32_t    PowerCut;           // EEPROM bytes written before the power fails, 0 = never
+	uint32_t    PowerCutFirst;      // sweep: replay a cut after each of these byte counts ...
+	uint32_t    PowerCutLast;       // ... up to this one, 0 = no sweep
+	const char *ReplayPath;         // write the journalled blocks here once booted and exit
+	bool        LcdAscii;
+	bool        Pty;
+	bool        Quiet;
+	bool        Verify;             // turn the checks kept in the statistics into the exit status
+	uint32_t    LcdBudget;          // LCD bytes per second -v allows, 0 = any
+	bool        BusCheck;           // replay the BK4819 register tables as single writes on exit
+	uint32_t    TimerCheckTicks;    // check the timer wheel for this many ticks instead of booting
+	uint32_t    InterruptPeriodMs;  // squelch edges from the BK4819 model, 0 = none
+} HOST_Options_t;
+
+extern HOST_Stats_t   gHostStats;
+extern HOST_Options_t gHostOptions;
+extern char         **gHostArgv;
+
+// register file
+uintptr_t HOST_Peripheral(uint32_t Address);
+bool      HOST_InPeripheral(void);
+volatile uint32_t *HOST_Register(uint32_t Address);
+void      HOST_Init(void);
+void      HOST_Exit(int Status) __attribute__((noreturn));
+void      HOST_Reset(void) __attribute__((noreturn));
+
+// clock and interrupts
+void      HOST_ClockInit(void);
+void      HOST_ClockStop(void);
+void      HOST_ClockPause(void);
+void      HOST_ClockResume(void);
+uint64_t  HOST_GetTimeUs(void);
+void      HOST_SkipTimeUs(uint32_t Delay);
+void      HOST_ServiceInterrupts(void);
+bool      HOST_InInterrupt(void);
+void      HOST_WaitForInterrupt(void);
+void      HOST_NvicEnable(int IRQn, bool bEnable);
+void      HOST_DisableIrq(void);
+void      HOST_EnableIrq(void);
+bool      HOST_IrqDisabled(void);
+bool      HOST_MainLoopRunning(void);
+
+// devices
+void      HOST_EEPROM_Init(const char *pPath);
+bool      HOST_EEPROM_Update(bool Scl, bool Sda);
+uint8_t   HOST_EEPROM_Peek(uint16_t Address);
+bool      HOST_EEPROM_Idle(void);
+void      HOST_EEPROM_Save(const char *pPath);
+void      HOST_POWERCUT_Sample(void);
+void      HOST_POWERCUT_Replay(uint32_t Bytes);
+int       HOST_POWERCUT_Check(void);
+void      HOST_BK4819_Init(void);
+bool      HOST_BK4819_Update(bool Scn, bool Scl, bool Sda);
+void      HOST_BK4819_AudioPath(bool On);
+int       HOST_BK4819_Check(void);
+void      HOST_ST7565_Write(uint8_t Value, bool Data);
+void      HOST_ST7565_Dump(void);
+void      HOST_ST7565_Check(void);
+void      HOST_DMA_Update(void);
+bool      HOST_DMA_SpiBusy(void);
+bool      HOST_DMA_IrqPending(void);
+bool      HOST_DMA_TakeIrq(void);
+void      HOST_UART_Init(void);
+void      HOST_UART_Transmit(uint8_t Value);
+void      HOST_UART_Update(void);
+void      HOST_UART_Access(bool MainLoopUart);
+bool      HOST_UART_TakeIrq(void);
+void      HOST_UART_Poll(void);
+void      HOST_KEYS_Init(const char *pScript);
+int       HOST_TIMERS_Check(uint32_t Ticks);
+uint32_t  HOST_KEYS_Columns(uint32_t Rows);
+bool      HOST_KEYS_Ptt(void);
+
+#endif
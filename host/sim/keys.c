@@ -0,0 +1,159 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "driver/gpio.h"
+#include "sim/hw.h"
+
+// Scripted key presses. The script is a list of tokens separated by spaces or
+// commas, evaluated against MCU time from boot:
+//   1500      wait 1.5s
+//   M         press MENU for the default 200ms, then release for 200ms
+//   5:1000    hold 5 for a second
+// Keys: 0-9 M(enu) U(p) D(own) E(xit) * F S1 S2 P(tt)
+
+#define DEFAULT_PRESS_MS 200U
+#define MAX_EVENTS       256U
+
+typedef struct {
+	uint64_t Start;
+	uint64_t End;
+	uint8_t  Row;      // 0 = side keys, wired straight to ground
+	uint8_t  Column;   // GPIOA pin
+	bool     Ptt;
+} KeyEvent_t;
+
+static const struct {
+	const char *Name;
+	uint8_t     Row;
+	uint8_t     Column;
+} gKeyMap[] = {
+	{ "S1", 0, GPIOA_PIN_KEYBOARD_0 }, { "S2", 0, GPIOA_PIN_KEYBOARD_1 },
+	{ "M",  1, GPIOA_PIN_KEYBOARD_0 }, { "1",  1, GPIOA_PIN_KEYBOARD_1 },
+	{ "4",  1, GPIOA_PIN_KEYBOARD_2 }, { "7",  1, GPIOA_PIN_KEYBOARD_3 },
+	{ "U",  2, GPIOA_PIN_KEYBOARD_0 }, { "2",  2, GPIOA_PIN_KEYBOARD_1 },
+	{ "5",  2, GPIOA_PIN_KEYBOARD_2 }, { "8",  2, GPIOA_PIN_KEYBOARD_3 },
+	{ "D",  3, GPIOA_PIN_KEYBOARD_0 }, { "3",  3, GPIOA_PIN_KEYBOARD_1 },
+	{ "6",  3, GPIOA_PIN_KEYBOARD_2 }, { "9",  3, GPIOA_PIN_KEYBOARD_3 },
+	{ "E",  4, GPIOA_PIN_KEYBOARD_0 }, { "*",  4, GPIOA_PIN_KEYBOARD_1 },
+	{ "0",  4, GPIOA_PIN_KEYBOARD_2 }, { "F",  4, GPIOA_PIN_KEYBOARD_3 },
+};
+
+static const uint8_t gRowPins[] = {
+	0,
+	GPIOA_PIN_KEYBOARD_4,
+	GPIOA_PIN_KEYBOARD_5,
+	GPIOA_PIN_KEYBOARD_6,
+	GPIOA_PIN_KEYBOARD_7,
+};
+
+static KeyEvent_t gEvents[MAX_EVENTS];
+static unsigned   gEventCount;
+
+void HOST_KEYS_Init(const char *pScript)
+{
+	uint64_t Time = 0;
+	char    *pCopy;
+	char    *pToken;
+
+	if (pScript == NULL)
+		return;
+
+	pCopy = strdup(pScript);
+	for (pToken = strtok(pCopy, " ,"); pToken != NULL; pToken = strtok(NULL, " ,")) {
+		char       *pHold = strchr(pToken, ':');
+		uint32_t    Hold  = DEFAULT_PRESS_MS;
+		KeyEvent_t *pEvent;
+		unsigned    i;
+
+		if (isdigit((unsigned char)pToken[0]) && pToken[1] != '\0' && pHold == NULL) {
+			Time += strtoul(pToken, NULL, 10) * 1000u;
+			continue;
+		}
+
+		if (pHold != NULL) {
+			*pHold = '\0';
+			Hold   = strtoul(pHold + 1, NULL, 10);
+		}
+
+		if (gEventCount == MAX_EVENTS) {
+			fprintf(stderr, "keys: script too long\n");
+			exit(1);
+		}
+
+		pEvent        = &gEvents[gEventCount];
+		pEvent->Start = Time;
+		pEvent->End   = Time + Hold * 1000u;
+		pEvent->Ptt   = strcmp(pToken, "P") == 0;
+
+		for (i = 0; !pEvent->Ptt && i < sizeof(gKeyMap) / sizeof(gKeyMap[0]); i++) {
+			if (strcmp(pToken, gKeyMap[i].Name) == 0) {
+				pEvent->Row    = gKeyMap[i].Row;
+				pEvent->Column = gKeyMap[i].Column;
+				break;
+			}
+		}
+
+		if (!pEvent->Ptt && i == sizeof(gKeyMap) / sizeof(gKeyMap[0])) {
+			fprintf(stderr, "keys: unknown key '%s'\n", pToken);
+			exit(1);
+		}
+
+		gEventCount++;
+		Time = pEvent->End + DEFAULT_PRESS_MS * 1000u;
+	}
+
+	free(pCopy);
+}
+
+static const KeyEvent_t *ActiveEvent(void)
+{
+	uint64_t Now;
+
+	if (gEventCount == 0)
+		return NULL;
+
+	Now = HOST_GetTimeUs();
+	for (unsigned i = 0; i < gEventCount; i++)
+		if (Now >= gEvents[i].Start && Now < gEvents[i].End)
+			return &gEvents[i];
+
+	return NULL;
+}
+
+uint32_t HOST_KEYS_Columns(uint32_t Rows)
+{
+	const KeyEvent_t *pEvent = ActiveEvent();
+
+	if (pEvent == NULL || pEvent->Ptt)
+		return 0;
+
+	if (pEvent->Row != 0 && (Rows >> gRowPins[pEvent->Row]) & 1U)
+		return 0;
+
+	return 1U << pEvent->Column;
+}
+
+bool HOST_KEYS_Ptt(void)
+{
+	const KeyEvent_t *pEvent = ActiveEvent();
+
+	return pEvent != NULL && pEvent->Ptt;
+}
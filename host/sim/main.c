@@ -0,0 +1,130 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "sim/hw.h"
+
+void Main(void);
+
+static void Usage(const char *pName)
+{
+	fprintf(stderr,
+		"usage: %s [options]\n"
+		"  -e FILE   EEPROM image, created if missing (default eeprom.bin)\n"
+		"  -o FILE   write the LCD as a PBM image on exit\n"
+		"  -a        print the LCD as text on exit\n"
+		"  -t MS     stop after MS milliseconds of MCU time\n"
+		"  -k KEYS   key script, e.g. \"3000 M 500 5:1000\"\n"
+		"  -c HZ     put a carrier on HZ\n"
+		"  -n RSSI   receiver noise floor in raw RSSI units (default 80)\n"
+		"  -s US[,US] BK4819 settling time after a retune, below and above 280MHz (default 300)\n"
+		"  -u        expose UART1 on a pseudo terminal\n"
+		"  -b FILE   log every BK4819 register frame to FILE\n"
+		"  -r        on exit, check every BK4819 register table against single register writes\n"
+		"  -i MS     open and close the BK4819 squelch every MS milliseconds or so\n"
+		"  -p BYTES  cut the power after BYTES bytes were written to the EEPROM\n"
+		"  -p FIRST-LAST  go on, but boot a copy cut after each of FIRST..LAST bytes and\n"
+		"            fail if one replays a journalled block as a value it never had\n"
+		"  -d FILE   write the journalled blocks as the firmware reads them to FILE once\n"
+		"            booted and exit\n"
+		"  -q        do not print statistics\n"
+		"  -v        exit with status 1 if the BK4819 shadow went stale or saved no read,\n"
+		"            or the LCD shadow went stale or gST7565_BytesSent was off\n"
+		"  -l BYTES  like -v, and also fail if more than BYTES per second went to the LCD\n"
+		"  -w TICKS  check the timer wheel against plain countdowns for TICKS ticks and exit\n",
+		pName);
+	exit(2);
+}
+
+static void ParseSettle(const char *pArg)
+{
+	char *pEnd;
+
+	gHostOptions.SettleUs[0] = strtoul(pArg, &pEnd, 10);
+	gHostOptions.SettleUs[1] = (*pEnd == ',') ? strtoul(pEnd + 1, NULL, 10) : gHostOptions.SettleUs[0];
+}
+
+static void ParsePowerCut(const char *pArg)
+{
+	char *pEnd;
+
+	gHostOptions.PowerCut = strtoul(pArg, &pEnd, 10);
+	if (*pEnd != '-')
+		return;
+
+	gHostOptions.PowerCutFirst = gHostOptions.PowerCut ? gHostOptions.PowerCut : 1;
+	gHostOptions.PowerCutLast  = strtoul(pEnd + 1, NULL, 10);
+	gHostOptions.PowerCut      = 0;
+	if (gHostOptions.PowerCutLast < gHostOptions.PowerCutFirst) {
+		fprintf(stderr, "-p %s: the range is empty\n", pArg);
+		exit(2);
+	}
+}
+
+static void OnInterrupt(int Signal)
+{
+	(void)Signal;
+	HOST_Exit(0);
+}
+
+int main(int argc, char *argv[])
+{
+	int Option;
+
+	gHostArgv = argv;
+	gHostOptions.EepromPath = "eeprom.bin";
+
+	while ((Option = getopt(argc, argv, "e:o:at:k:c:n:s:ub:ri:p:d:qvl:w:h")) != -1) {
+		switch (Option) {
+		case 'e': gHostOptions.EepromPath       = optarg;                        break;
+		case 'o': gHostOptions.LcdPath          = optarg;                        break;
+		case 'a': gHostOptions.LcdAscii         = true;                          break;
+		case 't': gHostOptions.RunTimeMs        = strtoul(optarg, NULL, 10);     break;
+		case 'k': gHostOptions.Keys             = optarg;                        break;
+		case 'c': gHostOptions.CarrierFrequency = strtoul(optarg, NULL, 10) / 10; break;
+		case 'n': gHostOptions.NoiseFloor       = strtoul(optarg, NULL, 10);     break;
+		case 's': ParseSettle(optarg);                                           break;
+		case 'u': gHostOptions.Pty              = true;                          break;
+		case 'b': gHostOptions.BusTracePath     = optarg;                        break;
+		case 'r': gHostOptions.BusCheck         = true;                          break;
+		case 'i': gHostOptions.InterruptPeriodMs = strtoul(optarg, NULL, 10);    break;
+		case 'p': ParsePowerCut(optarg);                                         break;
+		case 'd': gHostOptions.ReplayPath       = optarg;                        break;
+		case 'q': gHostOptions.Quiet            = true;                          break;
+		case 'v': gHostOptions.Verify           = true;                          break;
+		case 'l': gHostOptions.LcdBudget        = strtoul(optarg, NULL, 10);
+		          gHostOptions.Verify           = true;                          break;
+		case 'w': gHostOptions.TimerCheckTicks  = strtoul(optarg, NULL, 10);     break;
+		default:  Usage(argv[0]);
+		}
+	}
+
+	if (gHostOptions.TimerCheckTicks)
+		return HOST_TIMERS_Check(gHostOptions.TimerCheckTicks);
+
+	signal(SIGINT, OnInterrupt);
+	signal(SIGTERM, OnInterrupt);
+
+	HOST_Init();
+
+	Main();
+
+	return 0;
+}
@@ -0,0 +1,227 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "driver/eeprom.h"
+#include "sim/hw.h"
+
+// Power cut sweep (-p FIRST-LAST). The run goes on as usual, but before each
+// byte in the range reaches the EEPROM cells a copy of the image as it is at
+// that moment, possibly halfway through a page, is booted in a new simulator
+// (-d), which reports the journalled blocks as the firmware reads them once
+// boot is over. Meanwhile this run samples the same blocks after every write
+// cycle. A replay is good if every block holds a value this run had, and no
+// older one than the replay of the cut a byte earlier: a torn record must
+// leave the previous value, never a mix of both, and a cut halfway through a
+// compaction must not lose the newest values.
+//
+// The samples are taken from the SysTick with the I2C bus idle and the chip
+// done writing, through the firmware's own EEPROM_ReadBuffer(), that takes
+// about 15ms of MCU time each.
+
+#define BLOCK_SIZE  8U
+#define BLOCK_COUNT 30U    // 0x0E80, 0x0E88 and 0x0C80..0x0D5F
+
+typedef uint8_t Blocks_t[BLOCK_COUNT][BLOCK_SIZE];
+
+static Blocks_t *gSamples;       // what this run read, one set per write cycle
+static unsigned  gSampleCount;
+static uint64_t  gSampledCycles = UINT64_MAX;
+static Blocks_t *gReplays;       // what the replay of each cut read
+static bool     *gReplayed;
+static uint32_t  gReplayFailed;  // replays that didn't boot, or didn't report
+
+static uint16_t BlockAddress(unsigned int Block)
+{
+	if (Block == 0)
+		return 0x0E80;
+	if (Block == 1)
+		return 0x0E88;
+	return 0x0C80 + (Block - 2) * BLOCK_SIZE;
+}
+
+static void ReadBlocks(Blocks_t *pBlocks)
+{
+	for (unsigned int i = 0; i < BLOCK_COUNT; i++)
+		EEPROM_ReadBuffer(BlockAddress(i), (*pBlocks)[i], BLOCK_SIZE);
+}
+
+static bool Sweeping(void)
+{
+	return gHostOptions.PowerCutLast != 0;
+}
+
+// Index into gReplays, cut 0 (the image we started from) goes first
+static uint32_t ReplayIndex(uint32_t Bytes)
+{
+	return Bytes == 0 ? 0 : Bytes - gHostOptions.PowerCutFirst + 1;
+}
+
+void HOST_POWERCUT_Sample(void)
+{
+	if ((!Sweeping() && gHostOptions.ReplayPath == NULL) || !HOST_MainLoopRunning() || !HOST_EEPROM_Idle())
+		return;
+
+	if (gHostOptions.ReplayPath != NULL) {
+		Blocks_t Blocks;
+		FILE    *pFile;
+
+		ReadBlocks(&Blocks);
+		pFile = fopen(gHostOptions.ReplayPath, "wb");
+		if (pFile == NULL || fwrite(Blocks, sizeof(Blocks), 1, pFile) != 1) {
+			perror(gHostOptions.ReplayPath);
+			exit(1);
+		}
+		fclose(pFile);
+		exit(0);
+	}
+
+	if (gSampledCycles == gHostStats.EEPROM_WriteCycles)
+		return;
+
+	gSampledCycles = gHostStats.EEPROM_WriteCycles;
+	gSamples = realloc(gSamples, (gSampleCount + 1) * sizeof(Blocks_t));
+	ReadBlocks(&gSamples[gSampleCount++]);
+}
+
+// Boots the image cut after Bytes bytes in a simulator of its own and keeps
+// what it read. The MCU clock stands still meanwhile.
+void HOST_POWERCUT_Replay(uint32_t Bytes)
+{
+	static char CutPath[4096];
+	static char ReplayPath[4096];
+	char       *Argv[] = { gHostArgv[0], "-q", "-t", "10000", "-e", CutPath, "-d", ReplayPath, NULL };
+	const uint32_t Index = ReplayIndex(Bytes);
+	FILE       *pFile;
+	pid_t       Pid;
+	int         Status;
+
+	if (!Sweeping() || (Bytes != 0 && (Bytes < gHostOptions.PowerCutFirst || Bytes > gHostOptions.PowerCutLast)))
+		return;
+
+	if (gReplays == NULL) {
+		const uint32_t Count = gHostOptions.PowerCutLast - gHostOptions.PowerCutFirst + 2;
+
+		gReplays  = calloc(Count, sizeof(Blocks_t));
+		gReplayed = calloc(Count, sizeof(bool));
+		if (gReplays == NULL || gReplayed == NULL) {
+			perror("power cut");
+			exit(1);
+		}
+		snprintf(CutPath, sizeof(CutPath), "%s.cut", gHostOptions.EepromPath);
+		snprintf(ReplayPath, sizeof(ReplayPath), "%s.replay", gHostOptions.EepromPath);
+	}
+	if (gReplayed[Index])
+		return;
+
+	HOST_ClockPause();
+	HOST_EEPROM_Save(CutPath);
+	unlink(ReplayPath);
+	fflush(NULL);
+
+	Pid = fork();
+	if (Pid == 0) {
+		execv("/proc/self/exe", Argv);
+		_exit(127);
+	}
+	while (Pid > 0 && waitpid(Pid, &Status, 0) < 0 && errno == EINTR) {
+	}
+
+	pFile = fopen(ReplayPath, "rb");
+	if (Pid < 0 || !WIFEXITED(Status) || WEXITSTATUS(Status) != 0 || pFile == NULL ||
+	    fread(gReplays[Index], sizeof(Blocks_t), 1, pFile) != 1) {
+		if (gReplayFailed++ == 0)
+			fprintf(stderr, "power cut after %lu bytes: the replay didn't boot\n", (unsigned long)Bytes);
+	} else {
+		gReplayed[Index] = true;
+	}
+	if (pFile != NULL)
+		fclose(pFile);
+	unlink(CutPath);
+	unlink(ReplayPath);
+
+	HOST_ClockResume();
+}
+
+// Returns 1 if a replay went wrong
+int HOST_POWERCUT_Check(void)
+{
+	unsigned int Position[BLOCK_COUNT] = {0};
+	uint32_t     Replays = 0;
+	uint32_t     Bad     = 0;
+	uint32_t     Last;
+
+	if (!Sweeping())
+		return 0;
+
+	// the cut after the very last byte, nothing came after it to trigger one
+	HOST_POWERCUT_Replay(gHostStats.EEPROM_WriteBytes);
+
+	// the image we started from is what the first replay read
+	if (gReplays != NULL && gReplayed[0]) {
+		gSamples = realloc(gSamples, (gSampleCount + 1) * sizeof(Blocks_t));
+		memmove(gSamples + 1, gSamples, gSampleCount * sizeof(Blocks_t));
+		memcpy(gSamples[0], gReplays[0], sizeof(Blocks_t));
+		gSampleCount++;
+	}
+
+	Last = gHostOptions.PowerCutLast < gHostStats.EEPROM_WriteBytes ? gHostOptions.PowerCutLast : gHostStats.EEPROM_WriteBytes;
+
+	for (uint32_t Bytes = gHostOptions.PowerCutFirst; gReplays != NULL && Bytes <= Last; Bytes++) {
+		const uint32_t Index = ReplayIndex(Bytes);
+
+		if (!gReplayed[Index])
+			continue;
+		Replays++;
+
+		for (unsigned int i = 0; i < BLOCK_COUNT; i++) {
+			unsigned int Sample = Position[i];
+
+			while (Sample < gSampleCount && memcmp(gSamples[Sample][i], gReplays[Index][i], BLOCK_SIZE) != 0)
+				Sample++;
+
+			if (Sample < gSampleCount) {
+				Position[i] = Sample;
+				continue;
+			}
+
+			if (Bad++ == 0) {
+				bool Earlier = false;
+
+				for (Sample = 0; Sample < Position[i]; Sample++)
+					Earlier |= memcmp(gSamples[Sample][i], gReplays[Index][i], BLOCK_SIZE) == 0;
+
+				fprintf(stderr, "power cut after %lu bytes: %04X replays as %02X %02X %02X %02X %02X %02X %02X %02X, %s\n",
+					(unsigned long)Bytes, BlockAddress(i),
+					gReplays[Index][i][0], gReplays[Index][i][1], gReplays[Index][i][2], gReplays[Index][i][3],
+					gReplays[Index][i][4], gReplays[Index][i][5], gReplays[Index][i][6], gReplays[Index][i][7],
+					Earlier ? "older than the cut before it" : "which was never written");
+			}
+		}
+	}
+
+	if (!gHostOptions.Quiet || Bad || gReplayFailed)
+		fprintf(stderr, "power cuts        %lu replayed, %lu bad blocks, %lu failed to boot, %u samples\n",
+			(unsigned long)Replays, (unsigned long)Bad, (unsigned long)gReplayFailed, gSampleCount);
+
+	return Bad || gReplayFailed || Replays == 0;
+}
@@ -0,0 +1,117 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "driver/st7565.h"
+#include "sim/hw.h"
+
+// ST7565 display RAM: 8 pages of 132 columns, the panel shows columns 4..131.
+// Only page/column addressing and data writes are interpreted, the rest of the
+// command set (bias, contrast, power control, ...) is accepted and ignored.
+//
+// Every blit and every init starts with "start line 0", and none of them is
+// still being sent by then. That is where the shadow of the driver is held
+// against the display RAM: a valid page that differs counts as stale, and
+// gST7565_BytesSent has to match the bytes received so far. With the DMA the
+// shadow already holds the whole blit by the time the command gets here, so
+// the check waits for the end of the transfer instead (sim/dma.c).
+
+#define LCD_PAGES    8U
+#define LCD_COLUMNS  132U
+#define LCD_OFFSET   4U
+
+static uint8_t gRam[LCD_PAGES][LCD_COLUMNS];
+static uint8_t gPage;
+static uint8_t gColumn;
+
+void HOST_ST7565_Check(void)
+{
+	unsigned int Page;
+
+	if (gST7565_BytesSent != gHostStats.SPI_CommandBytes + gHostStats.SPI_DataBytes &&
+	    gHostStats.LCD_Miscounted++ == 0)
+		fprintf(stderr, "lcd counted %lu bytes, got %llu\n", (unsigned long)gST7565_BytesSent,
+			(unsigned long long)(gHostStats.SPI_CommandBytes + gHostStats.SPI_DataBytes));
+
+	for (Page = 0; Page < LCD_PAGES; Page++) {
+		if (!((gST7565_ShadowValid >> Page) & 1U) ||
+		    memcmp(gST7565_Shadow[Page], &gRam[Page][LCD_OFFSET], LCD_WIDTH) == 0)
+			continue;
+		if (gHostStats.LCD_Stale++ == 0)
+			fprintf(stderr, "lcd page %u differs from the driver's shadow\n", Page);
+	}
+}
+
+void HOST_ST7565_Write(uint8_t Value, bool Data)
+{
+	if (Data) {
+		gHostStats.SPI_DataBytes++;
+		if (Value != 0 && gHostStats.FirstFrameUs == 0) {
+			gHostStats.FirstFrameUs  = HOST_GetTimeUs();
+			gHostStats.FirstFrameI2C = gHostStats.I2C_Starts;
+		}
+		if (gColumn < LCD_COLUMNS)
+			gRam[gPage][gColumn++] = Value;
+		return;
+	}
+
+	gHostStats.SPI_CommandBytes++;
+
+	if (Value == 0x40) {
+		gHostStats.LCD_Redraws++;
+#ifndef ENABLE_LCD_DMA
+		HOST_ST7565_Check();
+#endif
+	} else if ((Value & 0xF0) == 0xB0) {
+		gPage = Value & 0x07;
+	} else if ((Value & 0xF0) == 0x10) {
+		gColumn = (gColumn & 0x0F) | (Value & 0x0F) << 4;
+	} else if ((Value & 0xF0) == 0x00) {
+		gColumn = (gColumn & 0xF0) | (Value & 0x0F);
+	}
+}
+
+void HOST_ST7565_Dump(void)
+{
+	if (gHostOptions.LcdPath != NULL) {
+		FILE *pFile = fopen(gHostOptions.LcdPath, "w");
+
+		if (pFile == NULL) {
+			perror(gHostOptions.LcdPath);
+		} else {
+			fprintf(pFile, "P1\n%u %u\n", LCD_WIDTH, LCD_PAGES * 8);
+			for (unsigned int y = 0; y < LCD_PAGES * 8; y++) {
+				for (unsigned int x = 0; x < LCD_WIDTH; x++)
+					fputc((gRam[y / 8][x + LCD_OFFSET] >> (y % 8)) & 1U ? '1' : '0', pFile);
+				fputc('\n', pFile);
+			}
+			fclose(pFile);
+		}
+	}
+
+	if (gHostOptions.LcdAscii) {
+		for (unsigned int y = 0; y < LCD_PAGES * 8; y += 2) {
+			for (unsigned int x = 0; x < LCD_WIDTH; x++) {
+				const uint8_t Column = gRam[y / 8][x + LCD_OFFSET] >> (y % 8);
+				static const char Glyph[] = " '.:";
+				fputc(Glyph[Column & 3U], stdout);
+			}
+			fputc('\n', stdout);
+		}
+	}
+}
@@ -0,0 +1,125 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "scheduler.h"
+#include "sim/hw.h"
+
+// Runs the timer wheel next to the countdown variables SystickHandler used
+// to decrement, with a seeded random mix of arm, re-arm, cancel and gate
+// changes between the ticks. Every timer has to fire on the same tick as its
+// countdown and report the same ticks left in between.
+
+#define TIMERS 8
+
+typedef struct {
+	uint32_t Count;       // the old countdown
+	bool     b500ms;      // decremented by the 500ms tick
+	bool     bGated;
+	bool     bCallback;
+} Reference_t;
+
+static SCHEDULER_Timer_t gTimers[TIMERS];
+static Reference_t       gReference[TIMERS] = {
+	{ .b500ms = false }, { .b500ms = false }, { .b500ms = false },
+	{ .bCallback = true }, { .bCallback = true },
+	{ .bGated = true }, { .bGated = true },
+	{ .b500ms = true },
+};
+static volatile bool     gFired[TIMERS];
+static bool              gGates[TIMERS];
+
+static void Callback3(void) { gFired[3] = true; }
+static void Callback4(void) { gFired[4] = true; }
+static bool Gate5(void)     { return gGates[5]; }
+static bool Gate6(void)     { return gGates[6]; }
+
+static void Arm(unsigned int Timer, uint32_t Count)
+{
+	gReference[Timer].Count = Count;
+
+	if (gReference[Timer].b500ms)
+		SCHEDULER_TimerArm500ms(&gTimers[Timer], Count);
+	else
+		SCHEDULER_TimerArm(&gTimers[Timer], Count);
+}
+
+int HOST_TIMERS_Check(uint32_t Ticks)
+{
+	uint32_t     Tick;
+	uint32_t     Fired = 0;
+	unsigned int Timer;
+
+	srand(1);
+
+	for (Timer = 0; Timer < TIMERS; Timer++) {
+		void (*pCallback)(void) = NULL;
+		bool (*pGate)(void)     = NULL;
+
+		if (Timer == 3) pCallback = Callback3;
+		if (Timer == 4) pCallback = Callback4;
+		if (Timer == 5) pGate     = Gate5;
+		if (Timer == 6) pGate     = Gate6;
+
+		SCHEDULER_TimerRegister(&gTimers[Timer], gReference[Timer].bCallback ? NULL : &gFired[Timer], pCallback, pGate);
+	}
+
+	for (Tick = 1; Tick <= Ticks; Tick++) {
+		// main loop work since the last tick
+		while (rand() % 4 == 0) {
+			Timer = rand() % TIMERS;
+			switch (rand() % 8) {
+			case 0:
+				Arm(Timer, 0);
+				break;
+			case 1:
+				gGates[Timer] = !gGates[Timer];
+				break;
+			default:
+				Arm(Timer, gReference[Timer].b500ms ? rand() % 4 : rand() % 160);
+				break;
+			}
+		}
+
+		SystickHandler();
+
+		for (Timer = 0; Timer < TIMERS; Timer++) {
+			Reference_t *pRef     = &gReference[Timer];
+			bool         bExpired = false;
+
+			if (pRef->b500ms ? (Tick % 50) == 0 : (!pRef->bGated || gGates[Timer]))
+				if (pRef->Count > 0)
+					bExpired = (--pRef->Count == 0);
+
+			if (gFired[Timer] != bExpired ||
+			    SCHEDULER_TimerPending(&gTimers[Timer]) != (pRef->Count > 0) ||
+			    (!pRef->b500ms && SCHEDULER_TimerRemaining(&gTimers[Timer]) != pRef->Count)) {
+				fprintf(stderr, "timer %u differs on tick %lu: fired %d/%d, %lu/%lu ticks left\n",
+					Timer, (unsigned long)Tick, gFired[Timer], bExpired,
+					(unsigned long)SCHEDULER_TimerRemaining(&gTimers[Timer]), (unsigned long)pRef->Count);
+				return 1;
+			}
+
+			Fired         += bExpired;
+			gFired[Timer]  = false;
+		}
+	}
+
+	fprintf(stderr, "timers            %lu ticks, %lu expiries, all on time\n", (unsigned long)Ticks, (unsigned long)Fired);
+	return 0;
+}
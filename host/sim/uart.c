@@ -0,0 +1,257 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <dp32g030/dma.h>
+#include <dp32g030/uart.h>
+
+#include "sim/hw.h"
+
+// UART1 on a pseudo terminal, so the usual programming tools can be pointed
+// at the simulator. Received bytes are placed into the RX DMA ring (channel 0
+// in loop mode) at the line rate and the channel status advances the write
+// index, which is all app/uart.c looks at.
+//
+// Transmitted bytes go through an 8 byte FIFO that drains at the line rate
+// set by BAUD, with the FIFO status bits in IF and the TXFIFO interrupt, so a
+// sender spins (or gets interrupted) as long as it would on the radio. TXFIFO
+// is modelled the strict way: latched when a byte leaves and the FIFO is down
+// to the TF level, cleared only by writing 1 to it. A handler that doesn't
+// clear it is called over and over, one that expects it to be raised by an
+// idle FIFO is never called. The RX FIFO is always empty (RX goes by DMA), so
+// RXFIFO_EMPTY is always set in what we put in IF and a value without it is
+// one the firmware wrote.
+//
+// The speed the tool on the other side configured on its end of the pty is
+// the line rate. When it is more than 5% off the one set in BAUD, bytes in
+// either direction arrive as garbage and are dropped (framing errors).
+
+#define DMA_CH0_ST  (*HOST_Register(DMA_CH0_BASE_ADDR + offsetof(DMA_Channel_t, ST)))
+#define UART1_REG(Field) (*HOST_Register(UART1_BASE_ADDR + offsetof(UART_Port_t, Field)))
+
+#define TX_FIFO_SIZE 8U
+
+extern uint8_t UART_DMA_Buffer[256];
+
+static int      gFd = -1;
+static int      gSlaveFd = -1;   // kept open to read the line speed
+static bool     gLineOk = true;
+static uint8_t  gTxFifo[TX_FIFO_SIZE];
+static unsigned gTxCount;
+static uint64_t gTxStartUs;    // when the oldest byte went on the wire
+static bool     gTxLevelHit;   // the latched TXFIFO flag
+static uint8_t  gRxQueue[1024];
+static unsigned gRxHead;
+static unsigned gRxCount;
+static uint64_t gRxDoneUs;     // when the oldest queued byte is complete
+static bool     gLastAccessUart;
+static bool     gLastAccessFull;
+static uint64_t gLastAccessUs;
+
+void HOST_UART_Init(void)
+{
+	struct termios tio;
+
+	if (!gHostOptions.Pty)
+		return;
+
+	gFd = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+	if (gFd < 0 || grantpt(gFd) != 0 || unlockpt(gFd) != 0) {
+		perror("pty");
+		exit(1);
+	}
+
+	tcgetattr(gFd, &tio);
+	cfmakeraw(&tio);
+	tcsetattr(gFd, TCSANOW, &tio);
+
+	gSlaveFd = open(ptsname(gFd), O_RDWR | O_NOCTTY | O_NONBLOCK);
+
+	fprintf(stderr, "uart: %s\n", ptsname(gFd));
+}
+
+static uint32_t SpeedToBaud(speed_t Speed)
+{
+	static const struct {
+		speed_t  Speed;
+		uint32_t Baud;
+	} Speeds[] = {
+		{ B9600,   9600   }, { B19200,  19200  }, { B38400,  38400  }, { B57600,  57600  },
+		{ B115200, 115200 }, { B230400, 230400 }, { B460800, 460800 }, { B921600, 921600 },
+	};
+
+	for (size_t i = 0; i < sizeof(Speeds) / sizeof(Speeds[0]); i++)
+		if (Speeds[i].Speed == Speed)
+			return Speeds[i].Baud;
+
+	return 0;
+}
+
+static void UpdateLineSpeed(void)
+{
+	struct termios tio;
+	uint32_t       Host;
+	uint32_t       Radio;
+
+	if (gSlaveFd < 0 || tcgetattr(gSlaveFd, &tio) != 0 || UART1_REG(BAUD) == 0)
+		return;
+
+	Host  = SpeedToBaud(cfgetospeed(&tio));
+	Radio = 48000000U / UART1_REG(BAUD);
+
+	// an unknown speed is taken as matching
+	gLineOk = Host == 0 || (Host > Radio ? Host - Radio : Radio - Host) * 20U <= Radio;
+}
+
+// 10 bits per byte, the firmware sets BAUD to the 48MHz clock over the bit rate
+static uint64_t ByteTimeUs(void)
+{
+	return (uint64_t)UART1_REG(BAUD) * 10U / 48U;
+}
+
+void HOST_UART_Transmit(uint8_t Value)
+{
+	if (gTxCount == TX_FIFO_SIZE) {
+		gHostStats.UART_TxOverruns++;
+		return;
+	}
+
+	if (gTxCount == 0)
+		gTxStartUs = HOST_GetTimeUs();
+	gTxFifo[gTxCount++] = Value;
+}
+
+// Bytes only reach the RX DMA ring at the line rate, the rest waits in the pty
+static void ReceiveBytes(uint64_t Now)
+{
+	const uint64_t ByteTime = ByteTimeUs();
+	uint32_t       Index    = DMA_CH0_ST & 0xFFFU;
+
+	if (gRxCount == 0)
+		return;
+
+	while (gRxCount > 0 && Now >= gRxDoneUs) {
+		UART_DMA_Buffer[Index] = gRxQueue[gRxHead];
+		Index    = (Index + 1) % sizeof(UART_DMA_Buffer);
+		gRxHead  = (gRxHead + 1) % sizeof(gRxQueue);
+		gRxCount--;
+		gRxDoneUs += ByteTime;
+	}
+
+	DMA_CH0_ST = (DMA_CH0_ST & ~0xFFFU) | Index;
+}
+
+void HOST_UART_Update(void)
+{
+	const uint64_t Now      = HOST_GetTimeUs();
+	const uint64_t ByteTime = ByteTimeUs();
+	const uint32_t Level    = (UART1_REG(FIFO) & UART_FIFO_TF_LEVEL_MASK) >> UART_FIFO_TF_LEVEL_SHIFT;
+	uint32_t       Status   = UART_IF_RXFIFO_EMPTY_BITS_SET;
+
+	if (!(UART1_REG(IF) & UART_IF_RXFIFO_EMPTY_MASK) && (UART1_REG(IF) & UART_IF_TXFIFO_MASK))
+		gTxLevelHit = false;
+
+	ReceiveBytes(Now);
+
+	while (gTxCount > 0 && Now >= gTxStartUs + ByteTime) {
+		const uint8_t Value = gTxFifo[0];
+
+		gTxCount--;
+		memmove(gTxFifo, gTxFifo + 1, gTxCount);
+		gTxStartUs += ByteTime;
+		gHostStats.UART_TxBytes++;
+		if (gTxCount == Level)
+			gTxLevelHit = true;
+
+		if (!gLineOk)
+			gHostStats.UART_FramingErrors++;
+		else if (gFd >= 0 && write(gFd, &Value, 1) != 1) {
+			// nobody listening on the other side, drop it like the line would
+		}
+	}
+
+	if (gTxLevelHit)
+		Status |= UART_IF_TXFIFO_BITS_SET;
+	if (gTxCount == 0)
+		Status |= UART_IF_TXFIFO_EMPTY_BITS_SET;
+	if (gTxCount == TX_FIFO_SIZE)
+		Status |= UART_IF_TXFIFO_FULL_BITS_SET;
+	if (gTxCount >= TX_FIFO_SIZE / 2)
+		Status |= UART_IF_TXFIFO_HFULL_BITS_SET;
+	if (gTxCount > 0)
+		Status |= UART_IF_TXBUSY_BITS_SET;
+
+	UART1_REG(IF) = Status;
+}
+
+// Called for every register access. Back to back UART1 accesses from the main
+// loop while the TX FIFO is full are a sender spinning on TXFIFO_FULL.
+void HOST_UART_Access(bool MainLoopUart)
+{
+	const uint64_t Now  = HOST_GetTimeUs();
+	const bool     Full = gTxCount == TX_FIFO_SIZE;
+
+	if (MainLoopUart && gLastAccessUart && gLastAccessFull)
+		gHostStats.UART_TxWaitUs += Now - gLastAccessUs;
+
+	gLastAccessUart = MainLoopUart;
+	gLastAccessFull = Full;
+	gLastAccessUs   = Now;
+}
+
+bool HOST_UART_TakeIrq(void)
+{
+	return (UART1_REG(IE) & UART_IE_TXFIFO_MASK) && gTxLevelHit;
+}
+
+void HOST_UART_Poll(void)
+{
+	uint8_t  Buffer[64];
+	ssize_t  Length;
+	size_t   Room = sizeof(gRxQueue) - gRxCount;
+
+	if (gFd < 0)
+		return;
+
+	UpdateLineSpeed();
+
+	Length = read(gFd, Buffer, Room < sizeof(Buffer) ? Room : sizeof(Buffer));
+	if (Length <= 0)
+		return;
+
+	gHostStats.UART_RxBytes += Length;
+
+	if (!gLineOk) {
+		gHostStats.UART_FramingErrors += Length;
+		return;
+	}
+
+	if (gRxCount == 0)
+		gRxDoneUs = HOST_GetTimeUs() + ByteTimeUs();
+
+	for (ssize_t i = 0; i < Length; i++) {
+		gRxQueue[(gRxHead + gRxCount) % sizeof(gRxQueue)] = Buffer[i];
+		gRxCount++;
+	}
+}
@@ -0,0 +1,448 @@
+#!/usr/bin/env python3
+
+# Reference client for the programming protocol, plain (unobfuscated) mode.
+# Works on a serial port or on the pty of the host simulator (`-u`):
+#
+#   host/uart-client.py /dev/pts/3 read dump.bin
+#   host/uart-client.py /dev/pts/3 --baud 460800 sread dump.bin
+#   host/uart-client.py /dev/pts/3 swrite image.bin --offset 0 --length 0x1E00
+#   host/uart-client.py /dev/pts/3 --rle swrite image.bin --length 0x1E00
+#   host/uart-client.py --rle-stats image.bin
+#   host/uart-client.py /dev/pts/3 fuzz log.txt --rounds 500
+#   host/uart-client.py /dev/pts/3 telemetry rssi.csv --interval 1 --seconds 60
+#   host/uart-client.py /dev/pts/3 spectrum waterfall.pgm --seconds 60
+
+import argparse
+import os
+import random
+import select
+import struct
+import sys
+import termios
+import time
+import tty
+
+SPEEDS = {
+    38400:  termios.B38400,
+    115200: termios.B115200,
+    230400: termios.B230400,
+    460800: termios.B460800,
+}
+
+OBFUSCATION = bytes([
+    0x16, 0x6C, 0x14, 0xE6, 0x2E, 0x91, 0x0D, 0x40, 0x21, 0x35, 0xD5, 0x40, 0x13, 0x03, 0xE9, 0x80
+])
+
+def obfuscate(data):
+    return bytes(b ^ OBFUSCATION[i % 16] for i, b in enumerate(data))
+
+def crc16(data):
+    crc = 0
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+# PackBits style, the same as the firmware: 0x00..0x7F + n+1 literal bytes,
+# 0x80..0xFF + one byte repeated n-0x80+3 times
+def rle_encode(data):
+    out = bytearray()
+    i = literal = 0
+    while i < len(data):
+        run = 1
+        while i + run < len(data) and run < 130 and data[i + run] == data[i]:
+            run += 1
+        if run < 3 and i + run < len(data):
+            i += run
+            continue
+        if run < 3:
+            i += run
+        while literal < i:
+            n = min(128, i - literal)
+            out += bytes([n - 1]) + data[literal:literal + n]
+            literal += n
+        if run >= 3:
+            out += bytes([0x80 + run - 3, data[i]])
+            i += run
+        literal = i
+    return bytes(out)
+
+def rle_decode(data, size):
+    out = bytearray()
+    i = 0
+    while len(out) < size:
+        control = data[i]
+        if control < 0x80:
+            out += data[i + 1:i + 2 + control]
+            i += 2 + control
+        else:
+            out += bytes([data[i + 1]]) * (control - 0x80 + 3)
+            i += 2
+    return bytes(out[:size])
+
+# largest run of data from the start, up to the 128 bytes the radio writes
+# per frame, whose encoding fits in limit bytes
+def rle_chunk(data, limit=0x80):
+    size = min(len(data), 0x80)
+    while len(rle_encode(data[:size])) > limit:
+        size = size // 2 // 8 * 8
+    return size
+
+class Radio:
+    def __init__(self, path):
+        self.fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+        tty.setraw(self.fd)
+        self.set_speed(38400)
+        self.buf = b''
+        self.ts = 0x6B35A2C1
+        self.wire = 0
+        self.sent = 0
+        self.obfuscated = False
+
+    def set_speed(self, rate):
+        attr = termios.tcgetattr(self.fd)
+        attr[4] = attr[5] = SPEEDS[rate]
+        termios.tcsetattr(self.fd, termios.TCSADRAIN, attr)
+
+    def send(self, cmd_id, body):
+        payload = struct.pack('<HH', cmd_id, len(body)) + body
+        body = payload + struct.pack('<H', crc16(payload))
+        if self.obfuscated:
+            body = obfuscate(body)
+        self.raw(b'\xab\xcd' + struct.pack('<H', len(payload)) + body + b'\xdc\xba')
+
+    def raw(self, data):
+        self.sent += len(data)
+        os.write(self.fd, data)
+
+    # returns (id, body, crc ok); the stock replies carry no CRC
+    def receive(self, timeout=2.0):
+        end = time.time() + timeout
+        while True:
+            i = self.buf.find(b'\xab\xcd')
+            if i >= 0 and len(self.buf) >= i + 4:
+                size = struct.unpack('<H', self.buf[i + 2:i + 4])[0]
+                if len(self.buf) >= i + 8 + size:
+                    body = self.buf[i + 4:i + 6 + size]
+                    if self.obfuscated:
+                        body = obfuscate(body)
+                    payload = body[:size]
+                    crc = struct.unpack('<H', body[size:])[0]
+                    self.buf = self.buf[i + 8 + size:]
+                    self.wire += size + 8
+                    cmd_id, length = struct.unpack('<HH', payload[:4])
+                    return cmd_id, payload[4:4 + length], crc == crc16(payload)
+            left = end - time.time()
+            if left <= 0:
+                raise TimeoutError('no reply')
+            if select.select([self.fd], [], [], left)[0]:
+                self.buf += os.read(self.fd, 4096)
+
+    def expect(self, cmd_id, timeout=2.0):
+        while True:
+            got, body, ok = self.receive(timeout)
+            if got == cmd_id:
+                return body, ok
+
+    def hello(self):
+        self.send(0x0514, struct.pack('<I', self.ts))
+        body, _ = self.expect(0x0515)
+        return body[:16].split(b'\0')[0].decode(errors='replace')
+
+    def baud(self, rate):
+        self.send(0x0531, struct.pack('<II', rate, self.ts))
+        body, _ = self.expect(0x0532)
+        if not body[4]:
+            raise RuntimeError('radio refused %d baud' % rate)
+        time.sleep(0.05)
+        self.set_speed(rate)
+        time.sleep(0.05)
+        # anything valid at the new rate confirms it
+        self.send(0x0531, struct.pack('<II', rate, self.ts))
+        self.expect(0x0532)
+
+    def read(self, offset, length):
+        data = b''
+        while len(data) < length:
+            size = min(0x80, length - len(data))
+            self.send(0x051B, struct.pack('<HBBI', offset + len(data), size, 0, self.ts))
+            body, _ = self.expect(0x051C)
+            data += body[4:4 + body[2]]
+        return data
+
+    def write(self, offset, data):
+        for pos in range(0, len(data), 0x80):
+            chunk = data[pos:pos + 0x80]
+            self.send(0x051D, struct.pack('<HBBI', offset + pos, len(chunk), 1, self.ts) + chunk)
+            self.expect(0x051E)
+
+    # sliding window: acknowledge every frame, a gap sends the same
+    # acknowledge again, which makes the radio go back to it
+    def stream_read(self, offset, length, window=8, rle=False):
+        data = bytearray()
+        end = offset + length
+        rewound = None
+        self.send(0x0533, struct.pack('<HHBB2xI', offset, length, window, rle, self.ts))
+        while offset + len(data) < end:
+            try:
+                got, body, ok = self.receive()
+            except TimeoutError:
+                self.send(0x0535, struct.pack('<H2xI', offset + len(data), self.ts))
+                continue
+            if got == 0x0534:
+                at, size = struct.unpack('<HB', body[:3])
+                chunk = body[4:4 + size]
+            elif got == 0x0536:
+                at, size = struct.unpack('<HH', body[:4])
+                chunk = rle_decode(body[4:], size) if ok else b''
+            else:
+                continue
+            if ok and at == offset + len(data):
+                data += chunk
+            elif rewound == offset + len(data):
+                continue    # already asked for it again
+            else:
+                rewound = offset + len(data)
+            self.send(0x0535, struct.pack('<H2xI', offset + len(data), self.ts))
+        return bytes(data)
+
+    # one frame in flight while the radio writes the previous one, the RX
+    # ring of the radio only has room for 256 bytes
+    def stream_write(self, offset, data, rle=False):
+        frames = []
+        pos = 0
+        while pos < len(data):
+            size = rle_chunk(data[pos:]) if rle else min(0x80, len(data) - pos)
+            if rle:
+                frame = (0x0539, struct.pack('<HHB3xI', offset + pos, size, 1, self.ts) + rle_encode(data[pos:pos + size]))
+            else:
+                frame = (0x0537, struct.pack('<HBBI', offset + pos, size, 1, self.ts) + data[pos:pos + size])
+            frames.append((offset + pos, frame))
+            pos += size
+        pending = []
+        while frames or pending:
+            while frames and sum(len(f[1]) + 12 for _, f in pending) + len(frames[0][1][1]) + 12 <= 256:
+                at, frame = frames.pop(0)
+                self.send(*frame)
+                pending.append((at, frame))
+            try:
+                body, ok = self.expect(0x0538)
+            except TimeoutError:
+                frames = pending + frames
+                pending = []
+                continue
+            at = struct.unpack('<H', body[:2])[0]
+            if ok and pending and pending[0][0] == at:
+                pending.pop(0)
+
+    # valid read requests in plain and obfuscated mode with random junk in
+    # between, half of which looks like the start of a frame. A junk header
+    # holds up the next request until enough bytes follow to show it is not
+    # a frame, so without a reply the host pads and asks again.
+    def request(self, cmd_id, body, reply_id, check):
+        for tries in range(8):
+            self.send(cmd_id, body)
+            try:
+                while True:
+                    reply, _ = self.expect(reply_id, 0.5)
+                    if check(reply):
+                        return tries
+            except TimeoutError:
+                self.raw(bytes(32))
+        raise TimeoutError('no reply to 0x%04X' % cmd_id)
+
+    def fuzz(self, rounds, seed, log):
+        rng = random.Random(seed)
+        retries = junk = 0
+        for n in range(rounds):
+            if rng.random() < 0.1:
+                # the obfuscated hello reaches the radio as ID 0x6902
+                self.obfuscated = not self.obfuscated
+                retries += self.request(0x0514, struct.pack('<I', self.ts), 0x0515, lambda r: True)
+            noise = bytearray(rng.randbytes(rng.randrange(48)))
+            kind = rng.randrange(4)
+            if kind == 1:       # false header
+                noise += b'\xab\xcd' + bytes([rng.randrange(256), rng.randrange(2)]) + rng.randbytes(rng.randrange(16))
+            elif kind == 2:     # bad CRC, good footer
+                cmd_id = rng.choice([0x051B, 0x051D, 0x0533, 0x1234])
+                body = rng.randbytes(rng.randrange(24))
+                payload = struct.pack('<HH', cmd_id, len(body)) + body
+                noise += b'\xab\xcd' + struct.pack('<H', len(payload)) + payload + struct.pack('<H', ~crc16(payload) & 0xFFFF) + b'\xdc\xba'
+            elif kind == 3:     # request cut short
+                noise += (b'\xab\xcd\x0c\x00\x1b\x05\x08\x00' + rng.randbytes(8))[:rng.randrange(2, 16)]
+            junk += len(noise)
+            self.raw(bytes(noise))
+
+            offset = rng.randrange(0x2000 - 0x80) & ~7
+            tries = self.request(0x051B, struct.pack('<HBBI', offset, 0x80, 0, self.ts), 0x051C,
+                                 lambda r: struct.unpack('<H', r[:2])[0] == offset)
+            if tries:
+                log.write('round %d: asked %d times after %s\n' % (n, tries + 1, noise.hex()))
+            retries += tries
+        return retries, junk
+
+    # 0x053C frames carry the duty cycle of the last 500 ms (0.1 %), then 8
+    # byte records: sequence, 10 ms tick, RSSI, noise and glitch indicators.
+    # A sequence that skips means records were dropped because the link
+    # couldn't keep up.
+    def telemetry(self, interval, seconds, out):
+        records = lost = bad = 0
+        last = None
+        self.send(0x053A, struct.pack('<B3xI', interval, self.ts))
+        body, _ = self.expect(0x053B)
+        if interval and not body[0]:
+            raise RuntimeError('radio refused telemetry, it needs ENABLE_UART_TX_IRQ')
+        out.write('sequence,tick,rssi,dbm,noise,glitch,duty\n')
+        end = time.time() + seconds
+        while time.time() < end:
+            try:
+                got, body, ok = self.receive(0.5)
+            except TimeoutError:
+                continue
+            if got != 0x053C:
+                continue
+            if not ok or len(body) % 8 != 2:
+                bad += 1
+                continue
+            duty = struct.unpack('<H', body[:2])[0]
+            for seq, tick, rssi, noise, glitch in struct.iter_unpack('<HHHBB', body[2:]):
+                if last is not None:
+                    lost += (seq - last - 1) & 0xFFFF
+                last = seq
+                records += 1
+                out.write('%d,%d,%d,%.1f,%d,%d,%.1f\n' % (seq, tick, rssi, rssi / 2 - 160, noise, glitch, duty / 10))
+        self.send(0x053A, struct.pack('<B3xI', 0, self.ts))
+        self.expect(0x053B)
+        return records, lost, bad
+
+    # 0x053D frames from the spectrum app (ENABLE_SPECTRUM_UART): the first
+    # bin as is, then the difference to the bin before (-127..127) or 0x80
+    # and the value. The radio doesn't answer commands meanwhile, and frames
+    # are obfuscated unless a host switched that off before.
+    def spectrum(self, seconds):
+        sweeps = []
+        lost = bad = 0
+        last = None
+        end = time.time() + seconds
+        while time.time() < end:
+            try:
+                got, body, ok = self.receive(0.5)
+            except TimeoutError:
+                continue
+            if not ok:
+                self.obfuscated = not self.obfuscated
+                bad += 1
+                continue
+            if got != 0x053D:
+                continue
+            freq, step, seq, bins = struct.unpack('<IIHB', body[:11])
+            data = body[12:]
+            rssi = [data[0] | data[1] << 8]
+            i = 2
+            while len(rssi) < bins:
+                if data[i] == 0x80:
+                    rssi.append(data[i + 1] | data[i + 2] << 8)
+                    i += 3
+                else:
+                    rssi.append((rssi[-1] + (data[i] ^ 0x80) - 0x80) & 0xFFFF)
+                    i += 1
+            if last is not None:
+                lost += (seq - last - 1) & 0xFFFF
+            last = seq
+            sweeps.append((freq, step, rssi))
+        return sweeps, lost, bad
+
+# one row per sweep, 0 (not measured) and 0xFFFF (blacklisted) are black
+def write_waterfall(path, sweeps):
+    width = max(len(rssi) for _, _, rssi in sweeps)
+    valid = [v for _, _, rssi in sweeps for v in rssi if 0 < v < 0xFFFF] or [0]
+    low, high = min(valid), max(max(valid), min(valid) + 1)
+    with open(path, 'wb') as out:
+        out.write(b'P5 %d %d 255\n' % (width, len(sweeps)))
+        for _, _, rssi in sweeps:
+            row = [(v - low) * 255 // (high - low) if 0 < v < 0xFFFF else 0 for v in rssi]
+            out.write(bytes(row + [0] * (width - len(row))))
+
+def main():
+    parser = argparse.ArgumentParser(description='UV-K5 programming protocol client')
+    parser.add_argument('port', nargs='?')
+    parser.add_argument('command', nargs='?', choices=['read', 'sread', 'write', 'swrite', 'fuzz', 'telemetry', 'spectrum'])
+    parser.add_argument('file')
+    parser.add_argument('--baud', type=int, choices=sorted(SPEEDS), default=38400)
+    parser.add_argument('--offset', type=lambda x: int(x, 0), default=0)
+    parser.add_argument('--length', type=lambda x: int(x, 0), default=0x2000)
+    parser.add_argument('--window', type=int, default=8)
+    parser.add_argument('--rounds', type=int, default=200, help='fuzz: requests to send')
+    parser.add_argument('--seed', type=int, default=1)
+    parser.add_argument('--interval', type=int, default=1, help='telemetry: 10 ms ticks between samples')
+    parser.add_argument('--seconds', type=float, default=10)
+    parser.add_argument('--rle', action='store_true', help='run length coded streaming')
+    parser.add_argument('--rle-stats', action='store_true', help='only show how well FILE compresses')
+    args = parser.parse_intermixed_args()
+
+    if args.rle_stats:
+        data = open(args.file, 'rb').read()[args.offset:args.offset + args.length]
+        for name, rle in (('plain', False), ('rle', True)):
+            wire = pos = 0
+            while pos < len(data):
+                size = rle_chunk(data[pos:]) if rle else min(0x80, len(data) - pos)
+                wire += 8 + 12 + (len(rle_encode(data[pos:pos + size])) if rle else size)
+                pos += size
+            print('%-5s %d bytes -> %d bytes on the wire' % (name, len(data), wire))
+        return
+
+    radio = Radio(args.port)
+    if args.command == 'spectrum':
+        start = time.time()
+        sweeps, lost, bad = radio.spectrum(args.seconds)
+        elapsed = time.time() - start
+        if sweeps:
+            write_waterfall(args.file, sweeps)
+            freq, step, rssi = sweeps[-1]
+            print('%.5f MHz + %d x %.2f kHz' % (freq / 1e5, len(rssi), step / 100))
+        print('spectrum %d sweeps in %.2f s, %.1f sweeps/s, %d dropped, %d bad frames, %d bytes/sweep' %
+              (len(sweeps), elapsed, len(sweeps) / elapsed, lost, bad, radio.wire / max(len(sweeps), 1)))
+        return
+
+    print('radio', radio.hello())
+    if args.baud != 38400:
+        radio.baud(args.baud)
+
+    radio.wire = radio.sent = 0
+    start = time.time()
+    if args.command == 'fuzz':
+        with open(args.file, 'w') as log:
+            retries, junk = radio.fuzz(args.rounds, args.seed, log)
+        elapsed = time.time() - start
+        print('fuzz %d requests in %.2f s, %.1f requests/s, %d junk bytes, %d asked again' %
+              (args.rounds, elapsed, args.rounds / elapsed, junk, retries))
+        return
+    if args.command == 'telemetry':
+        with open(args.file, 'w') as out:
+            records, lost, bad = radio.telemetry(args.interval, args.seconds, out)
+        elapsed = time.time() - start
+        print('telemetry %d records in %.2f s, %.1f records/s, %d lost, %d bad frames, %.1f bytes/record' %
+              (records, elapsed, records / elapsed, lost, bad, radio.wire / max(records, 1)))
+        return
+    if args.command == 'read':
+        data = radio.read(args.offset, args.length)
+    elif args.command == 'sread':
+        data = radio.stream_read(args.offset, args.length, args.window, args.rle)
+    else:
+        data = open(args.file, 'rb').read()[args.offset:args.offset + args.length]
+        if args.command == 'write':
+            radio.write(args.offset, data)
+        else:
+            radio.stream_write(args.offset, data, args.rle)
+    elapsed = time.time() - start
+
+    if args.command in ('read', 'sread'):
+        open(args.file, 'wb').write(data)
+
+    print('%s %d bytes in %.2f s, %.0f bytes/s, %d bytes sent, %d received' %
+          (args.command, len(data), elapsed, len(data) / elapsed, radio.sent, radio.wire))
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -36,6 +36,7 @@
 #include "helper/boot.h"
 #include "misc.h"
 #include "radio.h"
+#include "scheduler.h"
 #include "settings.h"
 #include "ui/lock.h"
 #include "ui/welcome.h"
@@ -67,11 +68,12 @@ void Main(void)
 		| SYSCON_DEV_CLK_GATE_AES_BITS_ENABLE
 		| SYSCON_DEV_CLK_GATE_PWM_PLUS0_BITS_ENABLE;
 
+	SCHEDULER_Init();
 	SYSTICK_Init();
 	BOARD_Init();
 	UART_Init();
 
-	boot_counter_10ms = 250;   // 2.5 sec
+	SCHEDULER_TimerArm(&gBootTimer, 250);   // 2.5 sec
 
 	UART_Send(UART_Version, strlen(UART_Version));
 
@@ -215,8 +217,9 @@ void Main(void)
 
 	while (1)
 	{
-		APP_Update();
-
+		// the slices go first: a wake from WFI is mostly the SysTick, and what
+		// it scheduled for APP_Update (a dual watch switch) can take most of a
+		// tick, which would leave the slice late
 		if (gNextTimeslice)
 		{
 			APP_TimeSlice10ms();
@@ -228,5 +231,11 @@ void Main(void)
 			APP_TimeSlice500ms();
 			gNextTimeslice_500ms = false;
 		}
+
+		APP_Update();
+
+		#ifdef ENABLE_WFI_IDLE
+			SCHEDULER_Idle();
+		#endif
 	}
 }
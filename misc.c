@@ -115,29 +115,29 @@ ChannelAttributes_t gMR_ChannelAttributes[FREQ_CHANNEL_LAST + 1];
 ChannelFrequencyAttributes gMR_ChannelFrequencyAttributes[MR_CHANNEL_LAST +1];
 #endif
 
-volatile uint16_t gBatterySaveCountdown_10ms = battery_save_count_10ms;
+SCHEDULER_Timer_t gBatterySaveTimer;
 
 volatile bool     gPowerSaveCountdownExpired;
 volatile bool     gSchedulePowerSave;
 
 volatile bool     gScheduleDualWatch = true;
 
-volatile uint16_t gDualWatchCountdown_10ms;
+SCHEDULER_Timer_t gDualWatchTimer;
 bool              gDualWatchActive           = false;
 
-volatile uint8_t  gSerialConfigCountDown_500ms;
+SCHEDULER_Timer_t gSerialConfigTimer;
 
 volatile bool     gNextTimeslice_500ms;
 
-volatile uint16_t gTxTimerCountdown_500ms;
+SCHEDULER_Timer_t gTxTimer;
 volatile bool     gTxTimeoutReached;
 
-volatile uint16_t gTailNoteEliminationCountdown_10ms;
+SCHEDULER_Timer_t gTailNoteEliminationTimer;
 
 volatile uint8_t    gVFOStateResumeCountdown_500ms;
 
 #ifdef ENABLE_NOAA
-	volatile uint16_t gNOAA_Countdown_10ms;
+	SCHEDULER_Timer_t gNOAA_Timer;
 #endif
 
 bool              gEnableSpeaker;
@@ -157,7 +157,7 @@ uint8_t           gBatteryVoltageIndex;
 bool     		  gCssBackgroundScan;
 
 volatile bool     gScheduleScanListen = true;
-volatile uint16_t gScanPauseDelayIn_10ms;
+SCHEDULER_Timer_t gScanPauseTimer;
 
 bool              gUpdateRSSI;
 #if defined(ENABLE_ALARM) || defined(ENABLE_TX1750)
@@ -226,14 +226,14 @@ bool              gF_LOCK = false;
 uint8_t           gShowChPrefix;
 
 volatile bool     gNextTimeslice;
-volatile uint8_t  gFoundCDCSSCountdown_10ms;
-volatile uint8_t  gFoundCTCSSCountdown_10ms;
+SCHEDULER_Timer_t gFoundCDCSSTimer;
+SCHEDULER_Timer_t gFoundCTCSSTimer;
 #ifdef ENABLE_VOX
-	volatile uint16_t gVoxStopCountdown_10ms;
+	SCHEDULER_Timer_t gVoxStopTimer;
 #endif
 volatile bool     gNextTimeslice40ms;
 #ifdef ENABLE_NOAA
-	volatile uint16_t gNOAACountdown_10ms = 0;
+	SCHEDULER_Timer_t gNOAAIncomingTimer;
 	volatile bool     gScheduleNOAA       = true;
 #endif
 volatile bool     gFlagTailNoteEliminationComplete;
@@ -241,7 +241,7 @@ volatile bool     gFlagTailNoteEliminationComplete;
 	volatile bool gScheduleFM;
 #endif
 
-volatile uint8_t  boot_counter_10ms;
+SCHEDULER_Timer_t gBootTimer;
 
 int16_t           gCurrentRSSI[2] = {0, 0};  // now one per VFO
 
@@ -23,6 +23,8 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#include "scheduler.h"
+
 #ifndef ARRAY_SIZE
 	#define ARRAY_SIZE(x) (sizeof(x) / sizeof(x[0]))
 #endif
@@ -216,30 +218,30 @@ typedef struct
 	bool         overSquelch; // determines whether signal is over squelch open threshold
 }  __attribute__((packed))  sLevelAttributes;
 
-extern volatile uint16_t     gBatterySaveCountdown_10ms;
+extern SCHEDULER_Timer_t     gBatterySaveTimer;
 
 extern volatile bool         gPowerSaveCountdownExpired;
 extern volatile bool         gSchedulePowerSave;
 
 extern volatile bool         gScheduleDualWatch;
 
-extern volatile uint16_t     gDualWatchCountdown_10ms;
+extern SCHEDULER_Timer_t     gDualWatchTimer;
 extern bool                  gDualWatchActive;
 
-extern volatile uint8_t      gSerialConfigCountDown_500ms;
+extern SCHEDULER_Timer_t     gSerialConfigTimer;
 
 extern volatile bool         gNextTimeslice_500ms;
 
-extern volatile uint16_t     gTxTimerCountdown_500ms;
+extern SCHEDULER_Timer_t     gTxTimer;
 extern volatile bool         gTxTimeoutReached;
 
-extern volatile uint16_t     gTailNoteEliminationCountdown_10ms;
+extern SCHEDULER_Timer_t     gTailNoteEliminationTimer;
 
 #ifdef ENABLE_FMRADIO
 	extern volatile uint16_t gFmPlayCountdown_10ms;
 #endif
 #ifdef ENABLE_NOAA
-	extern volatile uint16_t gNOAA_Countdown_10ms;
+	extern SCHEDULER_Timer_t gNOAA_Timer;
 #endif
 extern bool                  gEnableSpeaker;
 extern uint8_t               gKeyInputCountdown;
@@ -269,7 +271,7 @@ enum
 };
 
 extern volatile bool     gScheduleScanListen;
-extern volatile uint16_t gScanPauseDelayIn_10ms;
+extern SCHEDULER_Timer_t gScanPauseTimer;
 
 extern bool                  gUpdateRSSI;
 extern AlarmState_t          gAlarmState;
@@ -332,14 +334,14 @@ extern volatile bool         gNextTimeslice;
 extern bool                  gUpdateDisplay;
 extern bool                  gF_LOCK;
 extern uint8_t               gShowChPrefix;
-extern volatile uint8_t      gFoundCDCSSCountdown_10ms;
-extern volatile uint8_t      gFoundCTCSSCountdown_10ms;
+extern SCHEDULER_Timer_t     gFoundCDCSSTimer;
+extern SCHEDULER_Timer_t     gFoundCTCSSTimer;
 #ifdef ENABLE_VOX
-	extern volatile uint16_t gVoxStopCountdown_10ms;
+	extern SCHEDULER_Timer_t gVoxStopTimer;
 #endif
 extern volatile bool         gNextTimeslice40ms;
 #ifdef ENABLE_NOAA
-	extern volatile uint16_t gNOAACountdown_10ms;
+	extern SCHEDULER_Timer_t gNOAAIncomingTimer;
 	extern volatile bool     gScheduleNOAA;
 #endif
 extern volatile bool         gFlagTailNoteEliminationComplete;
@@ -349,7 +351,7 @@ extern volatile uint8_t      gVFOStateResumeCountdown_500ms;
 #endif
 extern int16_t               gCurrentRSSI[2];   // now one per VFO
 extern uint8_t               gIsLocked;
-extern volatile uint8_t      boot_counter_10ms;
+extern SCHEDULER_Timer_t     gBootTimer;
 
 int32_t NUMBER_AddWithWraparound(int32_t Base, int32_t Add, int32_t LowerLimit, int32_t UpperLimit);
 unsigned long StrToUL(const char * str);
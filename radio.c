@@ -410,8 +410,12 @@ void RADIO_ConfigureChannel(const unsigned int VFO, const unsigned int configure
 
 	pVfo->Compander = att.compander;
 
-	BK4819_InitAGC(gEeprom.RX_AGC, gTxVfo->Modulation);
-	BK4819_SetAGC(gEeprom.RX_AGC!=RX_AGC_OFF);
+	// at boot the VFOs are loaded before gTxVfo is selected, Main() sets up the AGC afterwards
+	if (gTxVfo != NULL)
+	{
+		BK4819_InitAGC(gEeprom.RX_AGC, gTxVfo->Modulation);
+		BK4819_SetAGC(gEeprom.RX_AGC!=RX_AGC_OFF);
+	}
 
 	RADIO_ConfigureSquelchAndOutputPower(pVfo);
 }
@@ -599,11 +603,6 @@ void RADIO_SetupRegisters(bool switchToForeground)
 		BK4819_WriteRegister(BK4819_REG_02, 0);
 		SYSTEM_DelayMs(1);
 	}
-	BK4819_WriteRegister(BK4819_REG_3F, 0);
-
-	// mic gain 0.5dB/step 0 to 31
-	BK4819_WriteRegister(BK4819_REG_7D, 0xE940 | (gEeprom.MIC_SENSITIVITY_TUNING & 0x1f));
-
 	uint32_t Frequency;
 	#ifdef ENABLE_NOAA
 		if (!IS_NOAA_CHANNEL(gRxVfo->CHANNEL_SAVE) || !gIsNoaaMode)
@@ -613,25 +612,36 @@ void RADIO_SetupRegisters(bool switchToForeground)
 	#else
 		Frequency = gRxVfo->pRX->Frequency + gEeprom.RX_OFFSET;
 	#endif
-	BK4819_SetFrequency(Frequency);
 
-	BK4819_SetupSquelch(
+	BK4819_RegWrite_t setup[6 + BK4819_SQUELCH_WRITES];
+	size_t            n = 0;
+
+	setup[n++] = (BK4819_RegWrite_t){BK4819_REG_3F, 0};
+
+	// mic gain 0.5dB/step 0 to 31
+	setup[n++] = (BK4819_RegWrite_t){BK4819_REG_7D, 0xE940 | (gEeprom.MIC_SENSITIVITY_TUNING & 0x1f)};
+
+	setup[n++] = (BK4819_RegWrite_t){BK4819_REG_38, (Frequency >>  0) & 0xFFFF};
+	setup[n++] = (BK4819_RegWrite_t){BK4819_REG_39, (Frequency >> 16) & 0xFFFF};
+
+	n += BK4819_SquelchWrites(&setup[n],
 		gRxVfo->SquelchOpenRSSIThresh,    gRxVfo->SquelchCloseRSSIThresh,
 		gRxVfo->SquelchOpenNoiseThresh,   gRxVfo->SquelchCloseNoiseThresh,
 		gRxVfo->SquelchCloseGlitchThresh, gRxVfo->SquelchOpenGlitchThresh);
 
-	BK4819_PickRXFilterPathBasedOnFrequency(Frequency);
-
-	// what does this in do ?
-	BK4819_ToggleGpioOut(BK4819_GPIO0_PIN28_RX_ENABLE, true);
+	// LNA path, and what does this in do ?
+	BK4819_SetRXFilterPathState(Frequency);
+	setup[n++] = (BK4819_RegWrite_t){BK4819_REG_33, BK4819_SetGpioOutState(BK4819_GPIO0_PIN28_RX_ENABLE, true)};
 
 	// AF RX Gain and DAC
 	//BK4819_WriteRegister(BK4819_REG_48, 0xB3A8);  // 1011 00 111010 1000
-	BK4819_WriteRegister(BK4819_REG_48,
+	setup[n++] = (BK4819_RegWrite_t){BK4819_REG_48,
 		(11u << 12)                 |     // ??? .. 0 ~ 15, doesn't seem to make any difference
 		( 0u << 10)                 |     // AF Rx Gain-1
 		(gEeprom.VOLUME_GAIN << 4) |     // AF Rx Gain-2
-		(gEeprom.DAC_GAIN    << 0));     // AF DAC Gain (after Gain-1 and Gain-2)
+		(gEeprom.DAC_GAIN    << 0)};     // AF DAC Gain (after Gain-1 and Gain-2)
+
+	BK4819_WriteRegisters(setup, n);
 
 
 	uint16_t InterruptMask = BK4819_REG_3F_SQUELCH_FOUND | BK4819_REG_3F_SQUELCH_LOST;
@@ -798,7 +808,7 @@ void RADIO_SetupRegisters(bool switchToForeground)
 			{
 				gIsNoaaMode          = true;
 				gNoaaChannel         = gRxVfo->CHANNEL_SAVE - NOAA_CHANNEL_FIRST;
-				gNOAA_Countdown_10ms = NOAA_countdown_2_10ms;
+				SCHEDULER_TimerArm(&gNOAA_Timer, NOAA_countdown_2_10ms);
 				gScheduleNOAA        = false;
 			}
 			else
@@ -928,7 +938,7 @@ void RADIO_PrepareTX(void)
 	if (gEeprom.DUAL_WATCH != DUAL_WATCH_OFF)
 	{	// dual-RX is enabled
 
-		gDualWatchCountdown_10ms = dual_watch_count_after_tx_10ms;
+		SCHEDULER_TimerArm(&gDualWatchTimer, dual_watch_count_after_tx_10ms);
 		gScheduleDualWatch       = false;
 
 		if (!gRxVfoIsActive)
@@ -964,7 +974,7 @@ void RADIO_PrepareTX(void)
 			}
 			else
 		#endif
-		if (gSerialConfigCountDown_500ms > 0)
+		if (SCHEDULER_TimerPending(&gSerialConfigTimer))
 		{	// TX is disabled or config upload/download in progress
 			State = VFO_STATE_TX_DISABLE;
 		}
@@ -1026,19 +1036,19 @@ void RADIO_PrepareTX(void)
 
 	FUNCTION_Select(FUNCTION_TRANSMIT);
 
-	gTxTimerCountdown_500ms = 0;            // no timeout
+	SCHEDULER_TimerCancel(&gTxTimer);            // no timeout
 
 	#if defined(ENABLE_ALARM) || defined(ENABLE_TX1750)
 		if (gAlarmState == ALARM_STATE_OFF)
 	#endif
 	{
 		if (gEeprom.TX_TIMEOUT_TIMER == 0)
-			gTxTimerCountdown_500ms = 60;   // 30 sec
+			SCHEDULER_TimerArm500ms(&gTxTimer, 60);   // 30 sec
 		else
 		if (gEeprom.TX_TIMEOUT_TIMER < (ARRAY_SIZE(gSubMenu_TOT) - 1))
-			gTxTimerCountdown_500ms = 120 * gEeprom.TX_TIMEOUT_TIMER;  // minutes
+			SCHEDULER_TimerArm500ms(&gTxTimer, 120 * gEeprom.TX_TIMEOUT_TIMER);  // minutes
 		else
-			gTxTimerCountdown_500ms = 120 * 15;  // 15 minutes
+			SCHEDULER_TimerArm500ms(&gTxTimer, 120 * 15);  // 15 minutes
 	}
 	gTxTimeoutReached    = false;
 
@@ -24,30 +24,234 @@
 #include "app/scanner.h"
 #include "audio.h"
 #include "functions.h"
+#include "scheduler.h"
 #include "helper/battery.h"
 #include "misc.h"
 #include "settings.h"
 
 #include "driver/backlight.h"
+#include "driver/bk4819.h"
 #include "bsp/dp32g030/gpio.h"
 #include "driver/gpio.h"
+#include "ARMCM0.h"
+#ifdef ENABLE_WFI_IDLE
+	#include "driver/systick.h"
+#endif
 
-#define DECREMENT(cnt) \
-	do {               \
-		if (cnt > 0)   \
-			cnt--;     \
-	} while (0)
-
-#define DECREMENT_AND_TRIGGER(cnt, flag) \
-	do {                                 \
-		if (cnt > 0)                     \
-			if (--cnt == 0)              \
-				flag = true;             \
-	} while (0)
+// power of two, a timer is hashed by its expiry tick modulo this
+#define WHEEL_SIZE 32
 
 static volatile uint32_t gGlobalSysTickCounter;
 
-void SystickHandler(void);
+static SCHEDULER_Timer_t *gWheel[WHEEL_SIZE];
+static SCHEDULER_Timer_t *gGatedTimers;
+
+#ifdef ENABLE_WFI_IDLE
+	// core clock cycles spent in WFI during the current 500ms
+	static uint32_t gIdleCycles;
+	// share of the last 500ms the core was awake, in 0.1%
+	static uint16_t gDutyCycle = 1000;
+#endif
+
+static SCHEDULER_Timer_t **TimerList(const SCHEDULER_Timer_t *pTimer)
+{
+	return pTimer->pGate ? &gGatedTimers : &gWheel[pTimer->Expiry % WHEEL_SIZE];
+}
+
+static void TimerUnlink(SCHEDULER_Timer_t *pTimer)
+{
+	if (pTimer->pPrev)
+		pTimer->pPrev->pNext = pTimer->pNext;
+	else
+		*TimerList(pTimer) = pTimer->pNext;
+
+	if (pTimer->pNext)
+		pTimer->pNext->pPrev = pTimer->pPrev;
+
+	pTimer->bArmed = false;
+}
+
+static void TimerLink(SCHEDULER_Timer_t *pTimer)
+{
+	SCHEDULER_Timer_t **ppList = TimerList(pTimer);
+
+	pTimer->pPrev = NULL;
+	pTimer->pNext = *ppList;
+	if (*ppList)
+		(*ppList)->pPrev = pTimer;
+	*ppList = pTimer;
+
+	pTimer->bArmed = true;
+}
+
+static void TimerFire(SCHEDULER_Timer_t *pTimer)
+{
+	TimerUnlink(pTimer);
+
+	if (pTimer->pFlag)
+		*pTimer->pFlag = true;
+
+	if (pTimer->pCallback)
+		pTimer->pCallback();
+}
+
+static void TimerTick(void)
+{
+	SCHEDULER_Timer_t *pTimer;
+	SCHEDULER_Timer_t *pNext;
+
+	// the rest of the slot expires on a later turn of the wheel
+	for (pTimer = gWheel[gGlobalSysTickCounter % WHEEL_SIZE]; pTimer; pTimer = pNext)
+	{
+		pNext = pTimer->pNext;
+		if (pTimer->Expiry == gGlobalSysTickCounter)
+			TimerFire(pTimer);
+	}
+
+	for (pTimer = gGatedTimers; pTimer; pTimer = pNext)
+	{
+		pNext = pTimer->pNext;
+		if (pTimer->pGate() && --pTimer->Expiry == 0)
+			TimerFire(pTimer);
+	}
+}
+
+// Timers are armed from the main loop and from interrupts alike, keep the
+// caller's interrupt mask
+static uint32_t TimerLock(void)
+{
+	const uint32_t Primask = __get_PRIMASK();
+
+	__disable_irq();
+	return Primask;
+}
+
+static void TimerUnlock(uint32_t Primask)
+{
+	__set_PRIMASK(Primask);
+}
+
+void SCHEDULER_TimerRegister(SCHEDULER_Timer_t *pTimer, volatile bool *pFlag, void (*pCallback)(void), bool (*pGate)(void))
+{
+	SCHEDULER_TimerCancel(pTimer);
+
+	pTimer->pFlag     = pFlag;
+	pTimer->pCallback = pCallback;
+	pTimer->pGate     = pGate;
+}
+
+// Fires after Ticks_10ms ticks, like a countdown set to that value. Arming
+// an armed timer restarts it, 0 cancels it.
+void SCHEDULER_TimerArm(SCHEDULER_Timer_t *pTimer, uint32_t Ticks_10ms)
+{
+	const uint32_t Primask = TimerLock();
+
+	if (pTimer->bArmed)
+		TimerUnlink(pTimer);
+
+	if (Ticks_10ms > 0)
+	{
+		pTimer->Expiry = pTimer->pGate ? Ticks_10ms : gGlobalSysTickCounter + Ticks_10ms;
+		TimerLink(pTimer);
+	}
+
+	TimerUnlock(Primask);
+}
+
+// Fires on the Count_500ms'th 500ms tick from now, like a countdown kept by
+// the 500ms tick. Not for gated timers.
+void SCHEDULER_TimerArm500ms(SCHEDULER_Timer_t *pTimer, uint16_t Count_500ms)
+{
+	const uint32_t Primask = TimerLock();
+	const uint32_t Now     = gGlobalSysTickCounter;
+
+	SCHEDULER_TimerArm(pTimer, Count_500ms ? (Now / 50 + Count_500ms) * 50 - Now : 0);
+
+	TimerUnlock(Primask);
+}
+
+void SCHEDULER_TimerCancel(SCHEDULER_Timer_t *pTimer)
+{
+	SCHEDULER_TimerArm(pTimer, 0);
+}
+
+// Ticks left, 0 once it has fired or when it isn't armed
+uint32_t SCHEDULER_TimerRemaining(const SCHEDULER_Timer_t *pTimer)
+{
+	const uint32_t Primask = TimerLock();
+	uint32_t       Remaining = 0;
+
+	if (pTimer->bArmed)
+		Remaining = pTimer->pGate ? pTimer->Expiry : pTimer->Expiry - gGlobalSysTickCounter;
+
+	TimerUnlock(Primask);
+
+	return Remaining;
+}
+
+static void BatterySaveExpired(void)
+{
+	// re-armed on every function change, so it can't have been held halfway
+	if (gCurrentFunction == FUNCTION_FOREGROUND)
+		gSchedulePowerSave = true;
+}
+
+static void PowerSaveExpired(void)
+{
+	// armed on entering power save and only re-armed in it
+	if (gCurrentFunction == FUNCTION_POWER_SAVE)
+		gPowerSaveCountdownExpired = true;
+}
+
+static bool DualWatchGate(void)
+{
+	return gScanStateDir == SCAN_OFF && !gCssBackgroundScan && gEeprom.DUAL_WATCH != DUAL_WATCH_OFF &&
+		gCurrentFunction != FUNCTION_MONITOR && gCurrentFunction != FUNCTION_TRANSMIT && gCurrentFunction != FUNCTION_RECEIVE;
+}
+
+#ifdef ENABLE_NOAA
+static bool NOAAGate(void)
+{
+	return gScanStateDir == SCAN_OFF && !gCssBackgroundScan && gEeprom.DUAL_WATCH == DUAL_WATCH_OFF && gIsNoaaMode &&
+		gCurrentFunction != FUNCTION_MONITOR && gCurrentFunction != FUNCTION_TRANSMIT && gCurrentFunction != FUNCTION_RECEIVE;
+}
+#endif
+
+static bool ScanPauseGate(void)
+{
+	return gScanStateDir != SCAN_OFF && gCurrentFunction != FUNCTION_MONITOR && gCurrentFunction != FUNCTION_TRANSMIT;
+}
+
+void SCHEDULER_Init(void)
+{
+	SCHEDULER_TimerRegister(&gTxTimer, &gTxTimeoutReached, NULL, NULL);
+	SCHEDULER_TimerRegister(&gSerialConfigTimer, NULL, NULL, NULL);
+	#ifdef ENABLE_NOAA
+		SCHEDULER_TimerRegister(&gNOAAIncomingTimer, NULL, NULL, NULL);
+		SCHEDULER_TimerRegister(&gNOAA_Timer, &gScheduleNOAA, NULL, NOAAGate);
+	#endif
+	SCHEDULER_TimerRegister(&gFoundCDCSSTimer, NULL, NULL, NULL);
+	SCHEDULER_TimerRegister(&gFoundCTCSSTimer, NULL, NULL, NULL);
+	SCHEDULER_TimerRegister(&gBatterySaveTimer, NULL, BatterySaveExpired, NULL);
+	SCHEDULER_TimerRegister(&gPowerSaveTimer, NULL, PowerSaveExpired, NULL);
+	SCHEDULER_TimerRegister(&gDualWatchTimer, &gScheduleDualWatch, NULL, DualWatchGate);
+	SCHEDULER_TimerRegister(&gScanPauseTimer, &gScheduleScanListen, NULL, ScanPauseGate);
+	SCHEDULER_TimerRegister(&gTailNoteEliminationTimer, &gFlagTailNoteEliminationComplete, NULL, NULL);
+	#ifdef ENABLE_VOICE
+		SCHEDULER_TimerRegister(&gVoiceTimer, &gFlagPlayQueuedVoice, NULL, NULL);
+	#endif
+	#ifdef ENABLE_VOX
+		SCHEDULER_TimerRegister(&gVoxStopTimer, NULL, NULL, NULL);
+	#endif
+	SCHEDULER_TimerRegister(&gBootTimer, NULL, NULL, NULL);
+
+	SCHEDULER_TimerArm(&gBatterySaveTimer, battery_save_count_10ms);
+}
+
+uint32_t SCHEDULER_GetTicks(void)
+{
+	return gGlobalSysTickCounter;
+}
 
 // we come here every 10ms
 void SystickHandler(void)
@@ -59,58 +263,53 @@ void SystickHandler(void)
 	if ((gGlobalSysTickCounter % 50) == 0)
 	{
 		gNextTimeslice_500ms = true;
-		
-		DECREMENT_AND_TRIGGER(gTxTimerCountdown_500ms, gTxTimeoutReached);
-		DECREMENT(gSerialConfigCountDown_500ms);
+
+		#ifdef ENABLE_WFI_IDLE
+			gDutyCycle  = 1000 - gIdleCycles / (50 * SYSTICK_TICK_CYCLES / 1000);
+			gIdleCycles = 0;
+		#endif
 	}
 
 	if ((gGlobalSysTickCounter & 3) == 0)
 		gNextTimeslice40ms = true;
 
-	#ifdef ENABLE_NOAA
-		DECREMENT(gNOAACountdown_10ms);
-	#endif
-
-	DECREMENT(gFoundCDCSSCountdown_10ms);
+	TimerTick();
+}
 
-	DECREMENT(gFoundCTCSSCountdown_10ms);
+#ifdef ENABLE_WFI_IDLE
+// Sleeps until the next interrupt unless a time slice is already due.
+// Interrupts are masked across the check, one arriving in between still ends
+// the WFI and its handler runs as soon as they are enabled again.
+void SCHEDULER_Idle(void)
+{
+	static FUNCTION_Type_t LastFunction;
 
-	if (gCurrentFunction == FUNCTION_FOREGROUND)
-		DECREMENT_AND_TRIGGER(gBatterySaveCountdown_10ms, gSchedulePowerSave);
+	// radio events wait for APP_Update, and a function change is usually
+	// followed by another state machine step, e.g. FUNCTION_INCOMING opening
+	// the audio path, so give either one more pass
+	const bool bBusy = (gCurrentFunction != LastFunction) || BK4819_EventPending();
 
-	if (gCurrentFunction == FUNCTION_POWER_SAVE)
-		DECREMENT_AND_TRIGGER(gPowerSave_10ms, gPowerSaveCountdownExpired);
+	LastFunction = gCurrentFunction;
 
-	if (gScanStateDir == SCAN_OFF && !gCssBackgroundScan && gEeprom.DUAL_WATCH != DUAL_WATCH_OFF)
-		if (gCurrentFunction != FUNCTION_MONITOR && gCurrentFunction != FUNCTION_TRANSMIT && gCurrentFunction != FUNCTION_RECEIVE)
-			DECREMENT_AND_TRIGGER(gDualWatchCountdown_10ms, gScheduleDualWatch);
+	__disable_irq();
 
-	#ifdef ENABLE_NOAA
-		if (gScanStateDir == SCAN_OFF && !gCssBackgroundScan && gEeprom.DUAL_WATCH == DUAL_WATCH_OFF)
-			if (gIsNoaaMode && gCurrentFunction != FUNCTION_MONITOR && gCurrentFunction != FUNCTION_TRANSMIT)
-				if (gCurrentFunction != FUNCTION_RECEIVE)
-					DECREMENT_AND_TRIGGER(gNOAA_Countdown_10ms, gScheduleNOAA);
-	#endif
-
-	if (gScanStateDir != SCAN_OFF)
-		if (gCurrentFunction != FUNCTION_MONITOR && gCurrentFunction != FUNCTION_TRANSMIT)
-			DECREMENT_AND_TRIGGER(gScanPauseDelayIn_10ms, gScheduleScanListen);
+	if (!bBusy && !gNextTimeslice && !gNextTimeslice_500ms)
+	{
+		const uint32_t Start = SYSTICK_GetElapsed();
+		uint32_t       End;
 
-	DECREMENT_AND_TRIGGER(gTailNoteEliminationCountdown_10ms, gFlagTailNoteEliminationComplete);
+		__WFI();
 
-	#ifdef ENABLE_VOICE
-		DECREMENT_AND_TRIGGER(gCountdownToPlayNextVoice_10ms, gFlagPlayQueuedVoice);
-	#endif
-	
-	#ifdef ENABLE_FMRADIO //gFM_ScanState is never different than FM_SCAN_OFF
-		// if (gFM_ScanState != FM_SCAN_OFF && gCurrentFunction != FUNCTION_MONITOR)
-		// 	if (gCurrentFunction != FUNCTION_TRANSMIT && gCurrentFunction != FUNCTION_RECEIVE)
-		// 		DECREMENT_AND_TRIGGER(gFmPlayStandardCountdown_10ms, gScheduleFM);
-	#endif
+		// the SysTick that woke us has reloaded the counter but not run yet
+		End = SYSTICK_GetElapsed();
+		gIdleCycles += (End >= Start) ? End - Start : SYSTICK_TICK_CYCLES - Start + End;
+	}
 
-	#ifdef ENABLE_VOX
-		DECREMENT(gVoxStopCountdown_10ms);
-	#endif
+	__enable_irq();
+}
 
-	DECREMENT(boot_counter_10ms);
+uint16_t SCHEDULER_GetDutyCycle(void)
+{
+	return gDutyCycle;
 }
+#endif
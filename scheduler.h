@@ -0,0 +1,64 @@
+/* Copyright 2024 kamilsss655
+ * https://github.com/kamilsss655
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// A countdown driven by the 10ms SysTick. Armed timers sit in a hashed wheel
+// keyed by the tick they expire on, so the interrupt only looks at the slot
+// for the current tick. On expiry the flag is set and/or the callback runs,
+// both from the interrupt.
+//
+// A timer with a gate only counts down on ticks the gate allows, its expiry
+// moves with every tick it is held. Those are kept on a separate list that
+// is walked every tick, so only use a gate for conditions that can change
+// halfway through a countdown.
+typedef struct SCHEDULER_Timer_t SCHEDULER_Timer_t;
+struct SCHEDULER_Timer_t
+{
+	SCHEDULER_Timer_t *pNext;
+	SCHEDULER_Timer_t *pPrev;
+	volatile uint32_t  Expiry;          // tick it fires on, ticks left when gated
+	volatile bool      bArmed;
+	volatile bool     *pFlag;
+	void             (*pCallback)(void);
+	bool             (*pGate)(void);
+};
+
+void     SystickHandler(void);
+
+void     SCHEDULER_Init(void);
+uint32_t SCHEDULER_GetTicks(void);
+void     SCHEDULER_TimerRegister(SCHEDULER_Timer_t *pTimer, volatile bool *pFlag, void (*pCallback)(void), bool (*pGate)(void));
+void     SCHEDULER_TimerArm(SCHEDULER_Timer_t *pTimer, uint32_t Ticks_10ms);
+void     SCHEDULER_TimerArm500ms(SCHEDULER_Timer_t *pTimer, uint16_t Count_500ms);
+void     SCHEDULER_TimerCancel(SCHEDULER_Timer_t *pTimer);
+uint32_t SCHEDULER_TimerRemaining(const SCHEDULER_Timer_t *pTimer);
+
+static inline bool SCHEDULER_TimerPending(const SCHEDULER_Timer_t *pTimer)
+{
+	return pTimer->bArmed;
+}
+
+#ifdef ENABLE_WFI_IDLE
+	void     SCHEDULER_Idle(void);
+	uint16_t SCHEDULER_GetDutyCycle(void);
+#endif
+
+#endif
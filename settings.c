@@ -211,31 +211,31 @@ void SETTINGS_SaveChannel(uint8_t Channel, uint8_t VFO, const VFO_Info_t *pVFO,
 		if (Mode >= 2 || !IS_MR_CHANNEL(Channel))
 		{	// copy VFO to a channel
 
-			uint8_t State[8];
+			uint8_t State[16];
 
 			((uint32_t *)State)[0] = pVFO->freq_config_RX.Frequency;
 			((uint32_t *)State)[1] = pVFO->TX_OFFSET_FREQUENCY;
-			EEPROM_WriteBuffer(OffsetVFO + 0, State, true);
 
-			State[0] =  pVFO->freq_config_RX.Code;
-			State[1] =  pVFO->freq_config_TX.Code;
-			State[2] = (pVFO->freq_config_TX.CodeType << 4) | pVFO->freq_config_RX.CodeType;
-			State[3] = (pVFO->Modulation << 4) | pVFO->TX_OFFSET_FREQUENCY_DIRECTION;
-			State[4] = 0
+			State[8]  =  pVFO->freq_config_RX.Code;
+			State[9]  =  pVFO->freq_config_TX.Code;
+			State[10] = (pVFO->freq_config_TX.CodeType << 4) | pVFO->freq_config_RX.CodeType;
+			State[11] = (pVFO->Modulation << 4) | pVFO->TX_OFFSET_FREQUENCY_DIRECTION;
+			State[12] = 0
 				| (pVFO->BUSY_CHANNEL_LOCK << 4)
 				| (pVFO->OUTPUT_POWER      << 2)
 				| ((pVFO->CHANNEL_BANDWIDTH != BK4819_FILTER_BW_WIDE) << 1)
 				| (pVFO->FrequencyReverse  << 0);
 			if(pVFO->CHANNEL_BANDWIDTH != BK4819_FILTER_BW_WIDE)
-				State[4] |= ((pVFO->CHANNEL_BANDWIDTH - 1) << 5);
-			State[5] = ((pVFO->DTMF_PTT_ID_TX_MODE & 7u) << 1)
+				State[12] |= ((pVFO->CHANNEL_BANDWIDTH - 1) << 5);
+			State[13] = ((pVFO->DTMF_PTT_ID_TX_MODE & 7u) << 1)
 #ifdef ENABLE_DTMF_CALLING
 				| ((pVFO->DTMF_DECODING_ENABLE & 1u) << 0)
 #endif
 			;
-			State[6] =  pVFO->STEP_SETTING;
-			State[7] =  pVFO->SCRAMBLING_TYPE;
-			EEPROM_WriteBuffer(OffsetVFO + 8, State, true);
+			State[14] =  pVFO->STEP_SETTING;
+			State[15] =  pVFO->SCRAMBLING_TYPE;
+			EEPROM_WriteBuffer(OffsetVFO + 0, State + 0, true);
+			EEPROM_WriteBuffer(OffsetVFO + 8, State + 8, true);
 
 			SETTINGS_UpdateChannel(Channel, pVFO, true);
 
@@ -248,13 +248,13 @@ void SETTINGS_SaveChannel(uint8_t Channel, uint8_t VFO, const VFO_Info_t *pVFO,
 				#else
 					if (Mode >= 3) {
 						SETTINGS_SaveChannelName(Channel, pVFO->Name);
-
-						#ifdef ENABLE_SPECTRUM_SHOW_CHANNEL_NAME
-							//update channel names stored in memory
-							BOARD_gMR_LoadChannels();
-						#endif
 					}
 				#endif
+
+				#ifdef ENABLE_SPECTRUM_SHOW_CHANNEL_NAME
+					// the frequency may have changed too
+					BOARD_gMR_InvalidateChannel(Channel);
+				#endif
 			}
 		}
 	}
@@ -268,6 +268,7 @@ void SETTINGS_SaveBatteryCalibration(const uint16_t * batteryCalibration)
 	buf[0] = batteryCalibration[4];
 	buf[1] = batteryCalibration[5];
 	EEPROM_WriteBuffer(0x1F48, buf, false);
+	EEPROM_Flush();
 }
 
 void SETTINGS_SaveChannelName(uint8_t channel, const char * name)
@@ -276,15 +277,17 @@ void SETTINGS_SaveChannelName(uint8_t channel, const char * name)
 	uint8_t  buf[16];
 	memset(&buf, 0x00, sizeof(buf));
 	memcpy(buf, name, MIN(strlen(name),10u));
-	EEPROM_WriteBuffer(0x0F50 + offset, buf, true);
-	EEPROM_WriteBuffer(0x0F58 + offset, buf + 8, true);
+	EEPROM_WriteBlock(0x0F50 + offset, buf, sizeof(buf), true);
+
+	#ifdef ENABLE_SPECTRUM_SHOW_CHANNEL_NAME
+		BOARD_gMR_InvalidateChannel(channel);
+	#endif
 }
 
 #ifdef ENABLE_ENCRYPTION
 void SETTINGS_SaveEncryptionKey()
 {
-	EEPROM_WriteBuffer(0x0F30, gEeprom.ENC_KEY, true);
-	EEPROM_WriteBuffer(0x0F38, gEeprom.ENC_KEY + 8, true);
+	EEPROM_WriteBlock(0x0F30, gEeprom.ENC_KEY, sizeof(gEeprom.ENC_KEY), true);
 	gRecalculateEncKey = true;
 }
 #endif
@@ -305,8 +308,7 @@ void SETTINGS_FetchChannelName(char *s, const int channel)
 		return;
 
 
-	EEPROM_ReadBuffer(0x0F50 + (channel * 16), s + 0, 8);
-	EEPROM_ReadBuffer(0x0F58 + (channel * 16), s + 8, 2);
+	EEPROM_ReadBuffer(0x0F50 + (channel * 16), s, 10);
 
 	for (i = 0; i < 10; i++)
 		if (s[i] < 32 || s[i] > 127)
@@ -349,6 +351,11 @@ void SETTINGS_UpdateChannel(uint8_t channel, const VFO_Info_t *pVFO, bool keep)
 
 		gMR_ChannelAttributes[channel] = att;
 
+		#ifdef ENABLE_SPECTRUM_SHOW_CHANNEL_NAME
+			// the name is only shown for valid channels
+			BOARD_gMR_InvalidateChannel(channel);
+		#endif
+
 		if (IS_MR_CHANNEL(channel)) {	// it's a memory channel
 			if (!keep) {
 				// clear/reset the channel name